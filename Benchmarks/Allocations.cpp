@@ -0,0 +1,253 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+/*!
+ * @file        Allocations.cpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/types.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#endif
+
+#include <ULog/ULog.h>
+#include <ULog/C/Log.h>
+#include "../ULog/source/CXX/CXX-Message-IMPL.hpp"
+
+static std::atomic< uint64_t > AllocationCount( 0 );
+
+/*
+ * With glibc, malloc itself is interposed, which also covers operator new
+ * and the C allocations in GetStringWithFormat. Elsewhere only operator new
+ * is replaced.
+ */
+#if defined( __GLIBC__ )
+
+extern "C"
+{
+    void * __libc_malloc( size_t size );
+    void * __libc_calloc( size_t count, size_t size );
+    void * __libc_realloc( void * p, size_t size );
+    
+    void * malloc( size_t size )
+    {
+        AllocationCount++;
+        
+        return __libc_malloc( size );
+    }
+    
+    void * calloc( size_t count, size_t size )
+    {
+        AllocationCount++;
+        
+        return __libc_calloc( count, size );
+    }
+    
+    void * realloc( void * p, size_t size )
+    {
+        AllocationCount++;
+        
+        return __libc_realloc( p, size );
+    }
+}
+
+#else
+
+void * operator new( size_t size )
+{
+    void * p;
+    
+    AllocationCount++;
+    
+    p = malloc( std::max< size_t >( size, 1 ) );
+    
+    if( p == nullptr )
+    {
+        throw std::bad_alloc();
+    }
+    
+    return p;
+}
+
+void * operator new[]( size_t size )
+{
+    return operator new( size );
+}
+
+void operator delete( void * p ) noexcept
+{
+    free( p );
+}
+
+void operator delete[]( void * p ) noexcept
+{
+    free( p );
+}
+
+#endif
+
+/*
+ * libstdc++ keeps up to 15 characters inline, against 22 for libc++, so
+ * assembling the prefix costs one more allocation there.
+ */
+#if defined( __GLIBCXX__ )
+#define PREFIX_BUDGET 10
+#else
+#define PREFIX_BUDGET 9
+#endif
+
+typedef struct
+{
+    const char                    * name;
+    double                          budget;
+    std::function< void( size_t ) > f;
+}
+Stage;
+
+/* Allocations per call once the path is warm */
+static double Count( size_t iterations, const std::function< void( size_t ) > & f )
+{
+    uint64_t start;
+    
+    f( iterations );
+    
+    start = AllocationCount;
+    
+    f( iterations );
+    
+    return static_cast< double >( AllocationCount - start ) / static_cast< double >( iterations );
+}
+
+static std::string Format( ULog::MessageAccess::IMPL & impl, const char * fmt, ... )
+{
+    va_list     ap;
+    std::string s;
+    
+    va_start( ap, fmt );
+    
+    s = impl.GetStringWithFormat( fmt, ap );
+    
+    va_end( ap );
+    
+    return s;
+}
+
+int main( int argc, char * argv[] )
+{
+    ULog::Logger                plain;
+    ULog::Logger                prefixed;
+    ULog::MessageAccess::IMPL   impl;
+    ULog::Message               message( ULog::Message::SourceCXX, ULog::Message::LevelInfo, "GET /api/v1/users/%d took %d ms", 42, 7 );
+    std::deque< ULog::Message > messages;
+    std::vector< Stage >        stages;
+    std::streambuf            * err;
+    size_t                      iterations;
+    bool                        failed;
+    
+    iterations = ( argc > 1 ) ? static_cast< size_t >( strtoull( argv[ 1 ], nullptr, 10 ) ) : 10000;
+    failed     = false;
+    
+    plain.SetHistoryLimit( 1000 );
+    plain.SetDisplayOptions( 0 );
+    prefixed.SetHistoryLimit( 1000 );
+    ULog::Logger::SharedInstance()->SetHistoryLimit( 1000 );
+    
+    /*
+     * Budgets are the current counts: a change that adds an allocation
+     * fails, and each optimization lowers its budget, down to zero.
+     */
+    stages =
+    {
+        {
+            "Message( fmt, ... )", 4,
+            [ & ]( size_t n ) { for( size_t i = 0; i < n; i++ ) { ULog::Message m( ULog::Message::SourceCXX, ULog::Message::LevelInfo, "GET /api/v1/users/%zu took %d ms", i, 7 ); } }
+        },
+        {
+            "Message( string )", 3,
+            [ & ]( size_t n ) { for( size_t i = 0; i < n; i++ ) { ULog::Message m( ULog::Message::SourceCXX, ULog::Message::LevelInfo, message.GetText() ); } }
+        },
+        {
+            "GetStringWithFormat", 2,
+            [ & ]( size_t n ) { for( size_t i = 0; i < n; i++ ) { Format( impl, "GET /api/v1/users/%zu took %d ms", i, 7 ); } }
+        },
+        {
+            "_messages push", 3,
+            [ & ]( size_t n ) { for( size_t i = 0; i < n; i++ ) { messages.insert( messages.end(), message ); if( messages.size() > 1000 ) { messages.pop_front(); } } }
+        },
+        {
+            "Logger::Log, no prefix", 5,
+            [ & ]( size_t n ) { for( size_t i = 0; i < n; i++ ) { plain.Log( ULog::Message::LevelInfo, "GET /api/v1/users/%zu took %d ms", i, 7 ); } }
+        },
+        {
+            "Logger::Log, full prefix", PREFIX_BUDGET,
+            [ & ]( size_t n ) { for( size_t i = 0; i < n; i++ ) { prefixed.Log( ULog::Message::LevelInfo, "GET /api/v1/users/%zu took %d ms", i, 7 ); } }
+        },
+        {
+            "ULog_Info", PREFIX_BUDGET,
+            [ & ]( size_t n ) { for( size_t i = 0; i < n; i++ ) { ULog_Info( "GET /api/v1/users/%zu took %d ms", i, 7 ); } }
+        }
+    };
+    
+    err = std::cerr.rdbuf( nullptr );
+    
+    for( const auto & stage: stages )
+    {
+        double n;
+        bool   over;
+        
+        n = Count( iterations, stage.f );
+        
+        /* Amortized growth (deque blocks) shows up as a fraction */
+        over   = n >= stage.budget + 0.5;
+        failed = failed || over;
+        
+        printf( "%-28s %6.2f allocations per call, budget %4.0f%s\n", stage.name, n, stage.budget, ( over ) ? "  FAILED" : "" );
+    }
+    
+    std::cerr.rdbuf( err );
+    
+    return ( failed ) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,140 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+/*!
+ * @file        Backpressure.cpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#include <ULog/ULog.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static void Run( const char * name, ULog::Logger::Backpressure policy, uint64_t timeout, size_t threads, size_t count, const std::string & path )
+{
+    ULog::Logger                         logger;
+    ULog::Statistics                     statistics;
+    std::streambuf                     * err;
+    std::vector< std::thread >           producers;
+    std::vector< std::vector< double > > latencies( threads );
+    std::vector< double >                all;
+    uint64_t                             drops;
+    
+    /* The file sink is the slow consumer */
+    logger.AddLogFile( path );
+    logger.SetQueueCapacity( 4096 );
+    logger.SetBackpressure( policy );
+    logger.SetBackpressureTimeout( timeout );
+    logger.SetBackpressureLevel( ULog::Message::LevelWarning );
+    
+    err = std::cerr.rdbuf( nullptr );
+    
+    auto start = std::chrono::steady_clock::now();
+    
+    for( size_t i = 0; i < threads; i++ )
+    {
+        producers.push_back
+        (
+            std::thread
+            (
+                [ &, i ]( void )
+                {
+                    latencies[ i ].reserve( count );
+                    
+                    for( size_t j = 0; j < count; j++ )
+                    {
+                        auto t = std::chrono::steady_clock::now();
+                        
+                        logger.Log( static_cast< ULog::Message::Level >( j % 8 ), "producer %zu message %zu", i, j );
+                        
+                        latencies[ i ].push_back( std::chrono::duration< double, std::nano >( std::chrono::steady_clock::now() - t ).count() );
+                    }
+                }
+            )
+        );
+    }
+    
+    for( auto & producer: producers )
+    {
+        producer.join();
+    }
+    
+    auto end = std::chrono::steady_clock::now();
+    
+    logger.Flush();
+    std::cerr.rdbuf( err );
+    
+    statistics = logger.GetStatistics();
+    drops      = 0;
+    
+    for( int reason = ULog::Statistics::DropNewest; reason <= ULog::Statistics::DropTimeout; reason++ )
+    {
+        drops += statistics.GetDrops( static_cast< ULog::Statistics::Drop >( reason ) );
+    }
+    
+    for( const auto & l: latencies )
+    {
+        all.insert( all.end(), l.begin(), l.end() );
+    }
+    
+    std::sort( all.begin(), all.end() );
+    
+    printf
+    (
+        "%-22s %10.0f msg/s  p50 %8.0f ns  p99 %10.0f ns  max %12.0f ns  dropped %8llu\n",
+        name,
+        static_cast< double >( all.size() ) / std::chrono::duration< double >( end - start ).count(),
+        all[ all.size() / 2 ],
+        all[ ( all.size() * 99 ) / 100 ],
+        all.back(),
+        static_cast< unsigned long long >( drops )
+    );
+}
+
+int main( int argc, char * argv[] )
+{
+    size_t      threads;
+    size_t      count;
+    std::string path;
+    
+    threads = ( argc > 1 ) ? static_cast< size_t >( strtoull( argv[ 1 ], nullptr, 10 ) ) : 4;
+    count   = ( argc > 2 ) ? static_cast< size_t >( strtoull( argv[ 2 ], nullptr, 10 ) ) : 100000;
+    path    = ( argc > 3 ) ? argv[ 3 ] : "ULog-Backpressure.log";
+    
+    Run( "block",                ULog::Logger::BackpressureBlock,          0, threads, count, path );
+    Run( "block, 1ms timeout",   ULog::Logger::BackpressureBlock,          1, threads, count, path );
+    Run( "drop newest",          ULog::Logger::BackpressureDropNewest,     0, threads, count, path );
+    Run( "drop oldest",          ULog::Logger::BackpressureDropOldest,     0, threads, count, path );
+    Run( "drop below warning",   ULog::Logger::BackpressureDropBelowLevel, 0, threads, count, path );
+    
+    remove( path.c_str() );
+    
+    return EXIT_SUCCESS;
+}
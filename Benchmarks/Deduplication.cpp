@@ -0,0 +1,84 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+/*!
+ * @file        Deduplication.cpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#include <ULog/ULog.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+static void Run( const char * name, size_t count, uint64_t window, bool flood )
+{
+    ULog::Logger      logger;
+    std::streambuf  * err;
+    
+    logger.SetDeduplicationWindow( window );
+    
+    err = std::cerr.rdbuf( nullptr );
+    
+    auto start = std::chrono::steady_clock::now();
+    
+    for( size_t i = 0; i < count; i++ )
+    {
+        logger.Error
+        (
+            "Connection to db-primary:5432 refused (attempt %zu), retrying with exponential backoff",
+            ( flood ) ? static_cast< size_t >( 1 ) : i
+        );
+    }
+    
+    logger.Flush();
+    
+    auto end = std::chrono::steady_clock::now();
+    
+    std::cerr.rdbuf( err );
+    
+    printf
+    (
+        "%-28s %8.1f ns/message, %zu messages kept\n",
+        name,
+        std::chrono::duration< double, std::nano >( end - start ).count() / static_cast< double >( count ),
+        logger.GetMessages().size()
+    );
+}
+
+int main( int argc, char * argv[] )
+{
+    size_t count;
+    
+    count = ( argc > 1 ) ? static_cast< size_t >( strtoull( argv[ 1 ], nullptr, 10 ) ) : 1000000;
+    
+    Run( "flood, no deduplication",    count, 0,    true );
+    Run( "flood, 1s window",           count, 1000, true );
+    Run( "distinct, no deduplication", count, 0,    false );
+    Run( "distinct, 1s window",        count, 1000, false );
+    
+    return EXIT_SUCCESS;
+}
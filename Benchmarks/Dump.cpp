@@ -0,0 +1,123 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+/*!
+ * @file        Dump.cpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#include <ULog/ULog.h>
+#include <ULog/CXX/SearchIndex.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static ULog::Message Make( uint64_t sequence, const std::string & text )
+{
+    ULog::Message m( ULog::Message::SourceCXX, ULog::Message::LevelInfo, text );
+    
+    m.SetSequence( sequence );
+    
+    return m;
+}
+
+static bool Check( const char * name, bool ok )
+{
+    printf( "%-44s %s\n", name, ( ok ) ? "OK" : "FAILED" );
+    
+    return ok;
+}
+
+static double Time( const ULog::Logger & logger, const std::string & query, size_t & matches )
+{
+    auto start = std::chrono::steady_clock::now();
+    
+    matches = logger.Search( query, 0 ).size();
+    
+    auto end = std::chrono::steady_clock::now();
+    
+    return std::chrono::duration< double, std::micro >( end - start ).count();
+}
+
+int main( int argc, char * argv[] )
+{
+    ULog::SearchIndex index;
+    ULog::Logger      logger;
+    std::streambuf  * err;
+    size_t            count;
+    size_t            matches;
+    double            build;
+    double            dumped;
+    bool              ok;
+    
+    count = ( argc > 1 ) ? static_cast< size_t >( strtoull( argv[ 1 ], nullptr, 10 ) ) : 100000;
+    ok    = true;
+    
+    /* A dump brings back sequences older than the index base */
+    for( uint64_t i = 100; i < 200; i++ )
+    {
+        index.Add( Make( i, "written message" ) );
+    }
+    
+    ok = Check( "SearchIndex::Add, older sequence", index.Add( Make( 50, "recorded message" ) ) ) && ok;
+    ok = Check( "SearchIndex::GetCandidates, older sequence", index.GetCandidates( "recorded" ).size() == 1 && index.GetCandidates( "recorded" )[ 0 ].second == 50 ) && ok;
+    ok = Check( "SearchIndex::GetCandidates, newer sequences", index.GetCandidates( "written" ).size() == 100 && index.GetCandidates( "written" )[ 0 ].second == 100 ) && ok;
+    
+    index.Remove( Make( 50, "recorded message" ) );
+    
+    ok = Check( "SearchIndex::Remove, older sequence", index.GetCount() == 100 && index.GetCandidates( "recorded" ).size() == 0 ) && ok;
+    
+    err = std::cerr.rdbuf( nullptr );
+    
+    logger.SetFlightRecorder( 100, ULog::Message::LevelInfo );
+    logger.SetFlightRecorderTrigger( ULog::Message::LevelError );
+    
+    for( size_t i = 0; i < 100; i++ )
+    {
+        logger.Debug( "recorded %zu", i );
+    }
+    
+    for( size_t i = 0; i < count; i++ )
+    {
+        logger.Info( "written %zu", i );
+    }
+    
+    build = Time( logger, "written", matches );
+    
+    logger.Error( "trigger" );
+    
+    dumped = Time( logger, "recorded", matches );
+    
+    std::cerr.rdbuf( err );
+    
+    ok = Check( "Logger::Search after a dump", matches == 100 ) && ok;
+    
+    printf( "First search (index build): %10.1f us\n", build );
+    printf( "Search after a dump:        %10.1f us\n", dumped );
+    
+    return ( ok ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
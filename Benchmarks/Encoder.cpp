@@ -0,0 +1,144 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+/*!
+ * @file        Encoder.cpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#include <ULog/ULog.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+static void NaiveAppendJSONString( std::string & out, const char * s, size_t length )
+{
+    static const char hex[] = "0123456789abcdef";
+    
+    out += '"';
+    
+    for( size_t i = 0; i < length; i++ )
+    {
+        unsigned char c = static_cast< unsigned char >( s[ i ] );
+        
+        switch( c )
+        {
+            case '"':   out += "\\\""; break;
+            case '\\':  out += "\\\\"; break;
+            case '\n':  out += "\\n";  break;
+            case '\r':  out += "\\r";  break;
+            case '\t':  out += "\\t";  break;
+            case '\b':  out += "\\b";  break;
+            case '\f':  out += "\\f";  break;
+            
+            default:
+                
+                if( c < 0x20 )
+                {
+                    out += "\\u00";
+                    out += hex[ c >> 4 ];
+                    out += hex[ c & 0x0F ];
+                }
+                else
+                {
+                    out += static_cast< char >( c );
+                }
+                
+                break;
+        }
+    }
+    
+    out += '"';
+}
+
+template< typename F >
+static double Run( const std::vector< std::string > & corpus, size_t iterations, F f )
+{
+    std::string out;
+    size_t      bytes;
+    
+    bytes = 0;
+    
+    out.reserve( 1 << 16 );
+    
+    auto start = std::chrono::steady_clock::now();
+    
+    for( size_t i = 0; i < iterations; i++ )
+    {
+        for( const auto & s: corpus )
+        {
+            out.clear();
+            f( out, s.data(), s.length() );
+            
+            bytes += s.length();
+        }
+    }
+    
+    auto end = std::chrono::steady_clock::now();
+    
+    return static_cast< double >( bytes ) / std::chrono::duration< double >( end - start ).count() / ( 1024.0 * 1024.0 * 1024.0 );
+}
+
+int main( int argc, char * argv[] )
+{
+    std::vector< std::string > corpus;
+    size_t                     iterations;
+    
+    iterations = ( argc > 1 ) ? static_cast< size_t >( strtoull( argv[ 1 ], nullptr, 10 ) ) : 2000;
+    
+    /* Typical log lines: mostly plain ASCII, a few quotes and an occasional newline */
+    for( size_t i = 0; i < 256; i++ )
+    {
+        std::string s;
+        
+        while( s.length() < 64 + ( i % 8 ) * 64 )
+        {
+            s += "Request handled by worker ";
+            s += std::to_string( i );
+            s += ( i % 4 == 0 ) ? " with \"quoted\" path C:\\tmp\n" : " in 12.5 ms, status OK; ";
+        }
+        
+        corpus.push_back( s );
+    }
+    
+    printf
+    (
+        "naive  JSON escape: %8.3f GiB/s\n",
+        Run( corpus, iterations, NaiveAppendJSONString )
+    );
+    printf
+    (
+        "ULog   JSON escape: %8.3f GiB/s\n",
+        Run( corpus, iterations, ULog::Encoder::AppendJSONString )
+    );
+    printf
+    (
+        "ULog logfmt value:  %8.3f GiB/s\n",
+        Run( corpus, iterations, ULog::Encoder::AppendLogfmtValue )
+    );
+    
+    return EXIT_SUCCESS;
+}
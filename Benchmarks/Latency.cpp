@@ -0,0 +1,270 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+/*!
+ * @file        Latency.cpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#include <ULog/ULog.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Log-linear histogram in the spirit of HdrHistogram: values below 128 ns
+ * are exact, larger ones keep their top 7 bits (under 1% error).
+ */
+class Histogram
+{
+    public:
+        
+        static const unsigned int SubBits  = 7;
+        static const uint64_t     SubCount = 1 << SubBits;
+        static const uint64_t     SubHalf  = SubCount / 2;
+        
+        Histogram( void ): _counts( SubCount + 64 * SubHalf, 0 ), _total( 0 ), _max( 0 )
+        {}
+        
+        void Add( uint64_t value )
+        {
+            this->_counts[ this->GetIndex( value ) ]++;
+            this->_total++;
+            this->_max = std::max( this->_max, value );
+        }
+        
+        void Add( const Histogram & o )
+        {
+            for( size_t i = 0; i < this->_counts.size(); i++ )
+            {
+                this->_counts[ i ] += o._counts[ i ];
+            }
+            
+            this->_total += o._total;
+            this->_max    = std::max( this->_max, o._max );
+        }
+        
+        uint64_t GetMax( void ) const
+        {
+            return this->_max;
+        }
+        
+        uint64_t GetPercentile( double percentile ) const
+        {
+            uint64_t target;
+            uint64_t seen;
+            
+            target = static_cast< uint64_t >( ( percentile / 100.0 ) * static_cast< double >( this->_total ) + 0.5 );
+            target = std::max< uint64_t >( target, 1 );
+            seen   = 0;
+            
+            for( size_t i = 0; i < this->_counts.size(); i++ )
+            {
+                seen += this->_counts[ i ];
+                
+                if( seen >= target )
+                {
+                    return std::min( this->GetValue( i ), this->_max );
+                }
+            }
+            
+            return this->_max;
+        }
+        
+    private:
+        
+        size_t GetIndex( uint64_t value ) const
+        {
+            unsigned int shift;
+            
+            if( value < SubCount )
+            {
+                return static_cast< size_t >( value );
+            }
+            
+            /* Shift so that the value keeps SubBits significant bits */
+            for( shift = 0; ( value >> shift ) >= SubCount; shift++ )
+            {}
+            
+            return static_cast< size_t >( SubCount + ( shift - 1 ) * SubHalf + ( ( value >> shift ) - SubHalf ) );
+        }
+        
+        /* Highest value that maps to the bucket */
+        uint64_t GetValue( size_t index ) const
+        {
+            uint64_t shift;
+            
+            if( index < SubCount )
+            {
+                return index;
+            }
+            
+            shift = ( index - SubCount ) / SubHalf + 1;
+            
+            return ( ( ( index - SubCount ) % SubHalf + SubHalf + 1 ) << shift ) - 1;
+        }
+        
+        std::vector< uint64_t > _counts;
+        uint64_t                _total;
+        uint64_t                _max;
+};
+
+typedef enum
+{
+    ModeSync  = 0,
+    ModeAsync = 1,
+    ModeDrop  = 2
+}
+Mode;
+
+/*
+ * With a rate, producers follow a fixed schedule and latency is measured
+ * from the intended start: a stalled call then also counts against the
+ * calls it delayed, instead of hiding them (coordinated omission).
+ */
+static void Run( const char * name, Mode mode, size_t producers, size_t count, size_t size, uint64_t rate )
+{
+    ULog::Logger               logger;
+    std::streambuf           * err;
+    std::vector< std::thread > threads;
+    std::vector< Histogram >   service( producers );
+    std::vector< Histogram >   response( producers );
+    Histogram                  s;
+    Histogram                  r;
+    std::string                payload( size, 'x' );
+    
+    logger.SetHistoryLimit( 100000 );
+    
+    if( mode != ModeSync )
+    {
+        logger.SetQueueCapacity( 4096 );
+        logger.SetBackpressure( ( mode == ModeAsync ) ? ULog::Logger::BackpressureBlock : ULog::Logger::BackpressureDropNewest );
+    }
+    
+    err = std::cerr.rdbuf( nullptr );
+    
+    for( size_t i = 0; i < producers; i++ )
+    {
+        threads.push_back
+        (
+            std::thread
+            (
+                [ &, i ]( void )
+                {
+                    auto                     start    = std::chrono::steady_clock::now();
+                    std::chrono::nanoseconds interval( ( rate > 0 ) ? 1000000000 / rate : 0 );
+                    
+                    for( size_t j = 0; j < count; j++ )
+                    {
+                        auto intended = start + interval * static_cast< int64_t >( j );
+                        auto t        = std::chrono::steady_clock::now();
+                        
+                        if( rate > 0 )
+                        {
+                            while( t < intended )
+                            {
+                                std::this_thread::yield();
+                                
+                                t = std::chrono::steady_clock::now();
+                            }
+                        }
+                        
+                        logger.Log( ULog::Message::LevelInfo, "%zu %s", j, payload.c_str() );
+                        
+                        auto end = std::chrono::steady_clock::now();
+                        
+                        service[ i ].Add( static_cast< uint64_t >( std::chrono::duration_cast< std::chrono::nanoseconds >( end - t ).count() ) );
+                        
+                        if( rate > 0 )
+                        {
+                            response[ i ].Add( static_cast< uint64_t >( std::chrono::duration_cast< std::chrono::nanoseconds >( end - intended ).count() ) );
+                        }
+                    }
+                }
+            )
+        );
+    }
+    
+    for( auto & thread: threads )
+    {
+        thread.join();
+    }
+    
+    logger.Flush();
+    std::cerr.rdbuf( err );
+    
+    for( size_t i = 0; i < producers; i++ )
+    {
+        s.Add( service[ i ] );
+        r.Add( response[ i ] );
+    }
+    
+    printf
+    (
+        "%-8s service   p50 %9llu  p99 %9llu  p99.9 %9llu  max %11llu ns\n",
+        name,
+        static_cast< unsigned long long >( s.GetPercentile( 50 ) ),
+        static_cast< unsigned long long >( s.GetPercentile( 99 ) ),
+        static_cast< unsigned long long >( s.GetPercentile( 99.9 ) ),
+        static_cast< unsigned long long >( s.GetMax() )
+    );
+    
+    if( rate > 0 )
+    {
+        printf
+        (
+            "%-8s response  p50 %9llu  p99 %9llu  p99.9 %9llu  max %11llu ns\n",
+            name,
+            static_cast< unsigned long long >( r.GetPercentile( 50 ) ),
+            static_cast< unsigned long long >( r.GetPercentile( 99 ) ),
+            static_cast< unsigned long long >( r.GetPercentile( 99.9 ) ),
+            static_cast< unsigned long long >( r.GetMax() )
+        );
+    }
+}
+
+int main( int argc, char * argv[] )
+{
+    size_t   producers;
+    size_t   count;
+    size_t   size;
+    uint64_t rate;
+    
+    producers = ( argc > 1 ) ? static_cast< size_t >( strtoull( argv[ 1 ], nullptr, 10 ) ) : 4;
+    count     = ( argc > 2 ) ? static_cast< size_t >( strtoull( argv[ 2 ], nullptr, 10 ) ) : 100000;
+    size      = ( argc > 3 ) ? static_cast< size_t >( strtoull( argv[ 3 ], nullptr, 10 ) ) : 64;
+    rate      = ( argc > 4 ) ? static_cast< uint64_t >( strtoull( argv[ 4 ], nullptr, 10 ) ) : 0;
+    
+    printf( "%zu producers, %zu messages each, %zu bytes, %s\n", producers, count, size, ( rate > 0 ) ? ( std::to_string( rate ) + " msg/s per producer" ).c_str() : "unpaced" );
+    
+    Run( "sync",  ModeSync,  producers, count, size, rate );
+    Run( "async", ModeAsync, producers, count, size, rate );
+    Run( "drop",  ModeDrop,  producers, count, size, rate );
+    
+    return EXIT_SUCCESS;
+}
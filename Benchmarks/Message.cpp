@@ -0,0 +1,187 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+/*!
+ * @file        Message.cpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/types.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#endif
+
+#include <ULog/ULog.h>
+#include "../ULog/source/CXX/CXX-Message-IMPL.hpp"
+
+static volatile uint64_t Sink = 0;
+
+static double Measure( size_t iterations, const std::function< void( void ) > & f )
+{
+    double best;
+    
+    best = 0;
+    
+    for( int run = 0; run < 5; run++ )
+    {
+        auto   start = std::chrono::steady_clock::now();
+        double ns;
+        
+        for( size_t i = 0; i < iterations; i++ )
+        {
+            f();
+        }
+        
+        ns   = std::chrono::duration< double, std::nano >( std::chrono::steady_clock::now() - start ).count() / static_cast< double >( iterations );
+        best = ( run == 0 ) ? ns : std::min( best, ns );
+    }
+    
+    return best;
+}
+
+static std::string Format( ULog::MessageAccess::IMPL & impl, const char * fmt, ... )
+{
+    va_list     ap;
+    std::string s;
+    
+    va_start( ap, fmt );
+    
+    s = impl.GetStringWithFormat( fmt, ap );
+    
+    va_end( ap );
+    
+    return s;
+}
+
+static void Stages( size_t count )
+{
+    ULog::MessageAccess::IMPL   impl;
+    ULog::Message               message( ULog::Message::SourceCXX, ULog::Message::LevelInfo, "GET /api/v1/users/%d took %d ms", 42, 7 );
+    std::deque< ULog::Message > messages;
+    size_t                      n;
+    
+    n = 0;
+    
+    printf( "%-32s %10.1f ns\n", "Message( fmt, ... )", Measure( count, [ & ]( void ) { ULog::Message m( ULog::Message::SourceCXX, ULog::Message::LevelInfo, "GET /api/v1/users/%zu took %d ms", n++, 7 ); Sink += m.GetTime(); } ) );
+    printf( "%-32s %10.1f ns\n", "IMPL allocation", Measure( count, [ & ]( void ) { void * p = ::operator new( sizeof( ULog::MessageAccess::IMPL ) ); Sink += reinterpret_cast< uintptr_t >( p ); ::operator delete( p ); } ) );
+    printf( "%-32s %10.1f ns\n", "SetTimeToCurrent", Measure( count, [ & ]( void ) { impl.SetTimeToCurrent(); Sink += impl._milliseconds; } ) );
+    printf( "%-32s %10.1f ns\n", "SetProcessToCurrent", Measure( count, [ & ]( void ) { impl.SetProcessToCurrent(); Sink += impl._pid; } ) );
+    printf( "%-32s %10.1f ns\n", "SetThreadToCurrent", Measure( count, [ & ]( void ) { impl.SetThreadToCurrent(); Sink += impl._tid; } ) );
+    printf( "%-32s %10.1f ns\n", "GetStringWithFormat", Measure( count, [ & ]( void ) { Sink += Format( impl, "GET /api/v1/users/%zu took %d ms", n++, 7 ).length(); } ) );
+    printf( "%-32s %10.1f ns\n", "GetTimeString", Measure( count, [ & ]( void ) { Sink += impl.GetTimeString( impl._time, impl._milliseconds ).length(); } ) );
+    
+    /* What Logger::IMPL::Write does when appending to its history */
+    printf
+    (
+        "%-32s %10.1f ns\n",
+        "copy into history",
+        Measure
+        (
+            count,
+            [ & ]( void )
+            {
+                messages.insert( messages.end(), message );
+                
+                if( messages.size() > 1000 )
+                {
+                    messages.pop_front();
+                }
+            }
+        )
+    );
+}
+
+/*
+ * Prefix assembly is measured through Logger::Log with a null console, as
+ * the difference with an empty prefix.
+ */
+static void Prefixes( size_t count )
+{
+    std::streambuf * err;
+    double           base;
+    
+    err  = std::cerr.rdbuf( nullptr );
+    base = 0;
+    
+    for( uint64_t options = 0; options < 16; options++ )
+    {
+        ULog::Logger logger;
+        uint64_t     o;
+        double       ns;
+        
+        o = options << 1;
+        
+        logger.SetHistoryLimit( 1000 );
+        logger.SetDisplayOptions( o );
+        
+        ns   = Measure( count, [ & ]( void ) { logger.Info( "GET /api/v1/users/%d took %d ms", 42, 7 ); } );
+        base = ( options == 0 ) ? ns : base;
+        
+        printf
+        (
+            "prefix %-7s %-4s %-6s %-5s       %10.1f ns  %+8.1f ns\n",
+            ( o & ULog::Logger::DisplayOptionProcess ) ? "process" : "",
+            ( o & ULog::Logger::DisplayOptionTime )    ? "time"    : "",
+            ( o & ULog::Logger::DisplayOptionSource )  ? "source"  : "",
+            ( o & ULog::Logger::DisplayOptionLevel )   ? "level"   : "",
+            ns,
+            ns - base
+        );
+    }
+    
+    std::cerr.rdbuf( err );
+}
+
+int main( int argc, char * argv[] )
+{
+    size_t count;
+    
+    count = ( argc > 1 ) ? static_cast< size_t >( strtoull( argv[ 1 ], nullptr, 10 ) ) : 200000;
+    
+    Stages( count );
+    Prefixes( count );
+    
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,138 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+/*!
+ * @file        Priority.cpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#include <ULog/ULog.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Latency of Critical messages, from the call until the logger has
+ * processed them, while Debug traffic keeps the queue full.
+ */
+static void Run( const char * name, ULog::Message::Level priority, bool sync, size_t threads, size_t count, const std::string & path )
+{
+    ULog::Logger               logger;
+    std::streambuf           * err;
+    std::vector< std::thread > flood;
+    std::vector< double >      latencies;
+    std::atomic< bool >        stop( false );
+    
+    logger.AddLogFile( path );
+    logger.SetQueueCapacity( 4096 );
+    logger.SetBackpressure( ULog::Logger::BackpressureBlock );
+    logger.SetPriorityLevel( priority );
+    logger.SetPrioritySyncEnabled( sync );
+    
+    err = std::cerr.rdbuf( nullptr );
+    
+    for( size_t i = 0; i < threads; i++ )
+    {
+        flood.push_back
+        (
+            std::thread
+            (
+                [ &, i ]( void )
+                {
+                    size_t j = 0;
+                    
+                    while( stop == false )
+                    {
+                        logger.Debug( "flood %zu message %zu", i, j++ );
+                    }
+                }
+            )
+        );
+    }
+    
+    std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+    
+    latencies.reserve( count );
+    
+    for( size_t i = 0; i < count; i++ )
+    {
+        auto t = std::chrono::steady_clock::now();
+        
+        logger.Critical( "critical message %zu", i );
+        
+        while( logger.GetStatistics().GetCount( ULog::Message::LevelCritical ) <= i )
+        {
+            std::this_thread::yield();
+        }
+        
+        latencies.push_back( std::chrono::duration< double, std::micro >( std::chrono::steady_clock::now() - t ).count() );
+        
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+    
+    stop = true;
+    
+    for( auto & thread: flood )
+    {
+        thread.join();
+    }
+    
+    logger.Flush();
+    std::cerr.rdbuf( err );
+    
+    std::sort( latencies.begin(), latencies.end() );
+    
+    printf
+    (
+        "%-22s p50 %10.1f us  p99 %10.1f us  max %10.1f us\n",
+        name,
+        latencies[ latencies.size() / 2 ],
+        latencies[ ( latencies.size() * 99 ) / 100 ],
+        latencies.back()
+    );
+}
+
+int main( int argc, char * argv[] )
+{
+    size_t      threads;
+    size_t      count;
+    std::string path;
+    
+    threads = ( argc > 1 ) ? static_cast< size_t >( strtoull( argv[ 1 ], nullptr, 10 ) ) : 4;
+    count   = ( argc > 2 ) ? static_cast< size_t >( strtoull( argv[ 2 ], nullptr, 10 ) ) : 200;
+    path    = ( argc > 3 ) ? argv[ 3 ] : "ULog-Priority.log";
+    
+    Run( "queued",                ULog::Message::LevelEmergency, false, threads, count, path );
+    Run( "priority lane",         ULog::Message::LevelCritical,  false, threads, count, path );
+    Run( "priority lane, fsync",  ULog::Message::LevelCritical,  true,  threads, count, path );
+    
+    remove( path.c_str() );
+    
+    return EXIT_SUCCESS;
+}
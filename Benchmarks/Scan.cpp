@@ -0,0 +1,116 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+/*!
+ * @file        Scan.cpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#include <ULog/ULog.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static double Run( ULog::Logger & logger, size_t threads, size_t bytes, size_t iterations, const std::string & query, uint64_t options )
+{
+    size_t matches;
+    
+    matches = 0;
+    
+    logger.SetScanThreads( threads );
+    
+    auto start = std::chrono::steady_clock::now();
+    
+    for( size_t i = 0; i < iterations; i++ )
+    {
+        matches += logger.GetMessages( query, options, ~static_cast< uint64_t >( 0 ), ~static_cast< uint64_t >( 0 ) ).size();
+    }
+    
+    auto end = std::chrono::steady_clock::now();
+    
+    if( matches == 0 )
+    {
+        fprintf( stderr, "warning: no match for \"%s\"\n", query.c_str() );
+    }
+    
+    return static_cast< double >( bytes * iterations ) / std::chrono::duration< double >( end - start ).count() / 1e9;
+}
+
+int main( int argc, char * argv[] )
+{
+    ULog::Logger      logger;
+    std::streambuf  * err;
+    size_t            count;
+    size_t            iterations;
+    size_t            bytes;
+    size_t            cores;
+    
+    count      = ( argc > 1 ) ? static_cast< size_t >( strtoull( argv[ 1 ], nullptr, 10 ) ) : 1000000;
+    iterations = ( argc > 2 ) ? static_cast< size_t >( strtoull( argv[ 2 ], nullptr, 10 ) ) : 10;
+    cores      = std::max< size_t >( 1, std::thread::hardware_concurrency() );
+    bytes      = 0;
+    
+    /* Keep the history, not the console output */
+    err = std::cerr.rdbuf( nullptr );
+    
+    for( size_t i = 0; i < count; i++ )
+    {
+        logger.Info
+        (
+            "GET /api/v1/users/%zu/orders?page=%zu took %zu ms, worker %zu, status %s",
+            i % 50000,
+            i % 17,
+            ( i * 7 ) % 900,
+            i % 16,
+            ( i % 1000 == 0 ) ? "Timeout" : "OK"
+        );
+    }
+    
+    std::cerr.rdbuf( err );
+    
+    for( const auto & m: logger.GetMessages() )
+    {
+        bytes += m.GetText().length();
+    }
+    
+    printf( "%zu messages, %.1f MB of text\n", count, static_cast< double >( bytes ) / 1e6 );
+    
+    for( size_t threads: { static_cast< size_t >( 1 ), static_cast< size_t >( 4 ), cores } )
+    {
+        printf
+        (
+            "%3zu core(s): %8.3f GB/s substring, %8.3f GB/s case-insensitive\n",
+            threads,
+            Run( logger, threads, bytes, iterations, "status Timeout", 0 ),
+            Run( logger, threads, bytes, iterations, "STATUS timeout", ULog::Logger::SearchOptionCaseInsensitive )
+        );
+    }
+    
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,492 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+/*!
+ * @file        Suite.cpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#include <ULog/ULog.h>
+#include <ULog/C/Log.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+/*
+ * Hot path benchmarks, written as JSON on stdout so results can be compared
+ * across releases. The stderr sink writes to the real stderr: redirect it
+ * (make bench sends it to /dev/null).
+ */
+
+typedef struct
+{
+    std::string name;
+    std::string unit;
+    double      value;
+    uint64_t    iterations;
+    double      counters[ 5 ];
+}
+Result;
+
+/*
+ * Hardware counters around each scenario, on Linux with
+ * ULOG_BENCH_COUNTERS=1. Counters that cannot be opened (no PMU, perf
+ * disabled by perf_event_paranoid) are left out of the results.
+ */
+class Counters
+{
+    public:
+        
+        static const size_t Count = 5;
+        
+        Counters( void )
+        {
+            for( size_t i = 0; i < Count; i++ )
+            {
+                this->_fds[ i ] = -1;
+            }
+        }
+        
+        ~Counters( void )
+        {
+            #ifdef __linux__
+            
+            for( size_t i = 0; i < Count; i++ )
+            {
+                if( this->_fds[ i ] >= 0 )
+                {
+                    close( this->_fds[ i ] );
+                }
+            }
+            
+            #endif
+        }
+        
+        static const char * GetName( size_t i )
+        {
+            static const char * names[ Count ] = { "cycles", "instructions", "cache-misses", "branch-misses", "context-switches" };
+            
+            return names[ i ];
+        }
+        
+        void Open( void )
+        {
+            #ifdef __linux__
+            
+            static const uint32_t types[ Count ]   = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_SOFTWARE };
+            static const uint64_t configs[ Count ] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_SW_CONTEXT_SWITCHES };
+            
+            for( size_t i = 0; i < Count; i++ )
+            {
+                struct perf_event_attr attr;
+                
+                memset( &attr, 0, sizeof( attr ) );
+                
+                attr.size           = sizeof( attr );
+                attr.type           = types[ i ];
+                attr.config         = configs[ i ];
+                attr.disabled       = 1;
+                attr.inherit        = 1; /* Also count the threads a scenario starts */
+                attr.exclude_kernel = ( types[ i ] == PERF_TYPE_HARDWARE ) ? 1 : 0;
+                attr.exclude_hv     = 1;
+                
+                this->_fds[ i ] = static_cast< int >( syscall( SYS_perf_event_open, &attr, 0, -1, -1, 0 ) );
+            }
+            
+            #endif
+        }
+        
+        bool IsAvailable( void ) const
+        {
+            for( size_t i = 0; i < Count; i++ )
+            {
+                if( this->_fds[ i ] >= 0 )
+                {
+                    return true;
+                }
+            }
+            
+            return false;
+        }
+        
+        void Start( void )
+        {
+            #ifdef __linux__
+            
+            for( size_t i = 0; i < Count; i++ )
+            {
+                if( this->_fds[ i ] >= 0 )
+                {
+                    ioctl( this->_fds[ i ], PERF_EVENT_IOC_RESET,  0 );
+                    ioctl( this->_fds[ i ], PERF_EVENT_IOC_ENABLE, 0 );
+                }
+            }
+            
+            #endif
+        }
+        
+        /* Values per iteration, negative when unavailable */
+        void Stop( size_t iterations, double * values )
+        {
+            for( size_t i = 0; i < Count; i++ )
+            {
+                values[ i ] = -1;
+                
+                #ifdef __linux__
+                
+                {
+                    uint64_t value;
+                    
+                    if( this->_fds[ i ] < 0 )
+                    {
+                        continue;
+                    }
+                    
+                    ioctl( this->_fds[ i ], PERF_EVENT_IOC_DISABLE, 0 );
+                    
+                    if( read( this->_fds[ i ], &value, sizeof( value ) ) == sizeof( value ) )
+                    {
+                        values[ i ] = static_cast< double >( value ) / static_cast< double >( iterations );
+                    }
+                }
+                
+                #else
+                
+                ( void )iterations;
+                
+                #endif
+            }
+        }
+        
+    private:
+        
+        int _fds[ Count ];
+};
+
+static std::vector< Result > Results;
+static Counters              PerformanceCounters;
+static double                LastCounters[ Counters::Count ];
+
+/* Best of a few runs, in nanoseconds per iteration, with that run's counters */
+static double Measure( size_t iterations, const std::function< void( size_t ) > & f )
+{
+    double best;
+    
+    best = 0;
+    
+    for( int run = 0; run < 3; run++ )
+    {
+        double values[ Counters::Count ];
+        double ns;
+        
+        PerformanceCounters.Start();
+        
+        auto start = std::chrono::steady_clock::now();
+        
+        f( iterations );
+        
+        ns = std::chrono::duration< double, std::nano >( std::chrono::steady_clock::now() - start ).count() / static_cast< double >( iterations );
+        
+        PerformanceCounters.Stop( iterations, values );
+        
+        if( run == 0 || ns < best )
+        {
+            best = ns;
+            
+            std::copy( std::begin( values ), std::end( values ), std::begin( LastCounters ) );
+        }
+    }
+    
+    return best;
+}
+
+static void Report( const std::string & name, const std::string & unit, double value, uint64_t iterations )
+{
+    Result r;
+    
+    r.name       = name;
+    r.unit       = unit;
+    r.value      = value;
+    r.iterations = iterations;
+    
+    std::copy( std::begin( LastCounters ), std::end( LastCounters ), std::begin( r.counters ) );
+    
+    Results.push_back( r );
+}
+
+static void Throughput( size_t threads, size_t count )
+{
+    for( size_t n = 1; n <= threads; n = ( n < threads && n * 2 > threads ) ? threads : n * 2 )
+    {
+        double ns;
+        
+        ns = Measure
+        (
+            count,
+            [ & ]( size_t iterations )
+            {
+                ULog::Logger               logger;
+                std::vector< std::thread > workers;
+                
+                logger.SetHistoryLimit( 100000 );
+                
+                for( size_t i = 0; i < n; i++ )
+                {
+                    workers.push_back
+                    (
+                        std::thread
+                        (
+                            [ &, i ]( void )
+                            {
+                                for( size_t j = i; j < iterations; j += n )
+                                {
+                                    logger.Log( ULog::Message::SourceCXX, ULog::Message::LevelInfo, "thread %zu message %zu", i, j );
+                                }
+                            }
+                        )
+                    );
+                }
+                
+                for( auto & worker: workers )
+                {
+                    worker.join();
+                }
+            }
+        );
+        
+        Report( "log/threads/" + std::to_string( n ), "msg/s", 1e9 / ns, count );
+    }
+}
+
+static void Disabled( size_t count )
+{
+    ULog::Logger logger;
+    double       ns;
+    
+    logger.SetEnabled( false );
+    
+    ns = Measure
+    (
+        count,
+        [ & ]( size_t iterations )
+        {
+            for( size_t i = 0; i < iterations; i++ )
+            {
+                logger.Debug( "disabled message %zu", i );
+            }
+        }
+    );
+    
+    Report( "log/disabled", "ns/op", ns, count );
+}
+
+static void Construction( size_t count )
+{
+    double ns;
+    
+    ns = Measure
+    (
+        count,
+        [ & ]( size_t iterations )
+        {
+            for( size_t i = 0; i < iterations; i++ )
+            {
+                ULog::Message m( ULog::Message::SourceCXX, ULog::Message::LevelInfo, "message %zu", i );
+            }
+        }
+    );
+    
+    Report( "message/construct", "ns/op", ns, count );
+}
+
+static void History( size_t count )
+{
+    ULog::Logger logger;
+    double       ns;
+    
+    for( size_t i = 0; i < count; i++ )
+    {
+        logger.Info( "history message %zu", i );
+    }
+    
+    ns = Measure
+    (
+        1,
+        [ & ]( size_t )
+        {
+            std::vector< ULog::Message > messages( logger.GetMessages() );
+        }
+    );
+    
+    Report( "getmessages/" + std::to_string( count ), "ms", ns / 1e6, count );
+}
+
+static void Sink( const std::string & name, size_t count, const std::function< void( ULog::Logger & ) > & setup )
+{
+    double ns;
+    
+    ns = Measure
+    (
+        count,
+        [ & ]( size_t iterations )
+        {
+            ULog::Logger logger;
+            
+            logger.SetHistoryLimit( 100000 );
+            setup( logger );
+            
+            for( size_t i = 0; i < iterations; i++ )
+            {
+                logger.Info( "sink message %zu", i );
+            }
+        }
+    );
+    
+    Report( "sink/" + name, "ns/op", ns, count );
+}
+
+static void API( size_t count )
+{
+    double ns;
+    
+    ULog::Logger::SharedInstance()->SetHistoryLimit( 100000 );
+    
+    ns = Measure
+    (
+        count,
+        [ & ]( size_t iterations )
+        {
+            for( size_t i = 0; i < iterations; i++ )
+            {
+                ULog_Info( "c message %zu", i );
+            }
+        }
+    );
+    
+    Report( "api/c", "ns/op", ns, count );
+    
+    ns = Measure
+    (
+        count,
+        [ & ]( size_t iterations )
+        {
+            for( size_t i = 0; i < iterations; i++ )
+            {
+                ULog::Logger::SharedInstance()->Info( "cxx message %zu", i );
+            }
+        }
+    );
+    
+    Report( "api/cxx", "ns/op", ns, count );
+}
+
+int main( int argc, char * argv[] )
+{
+    size_t           threads;
+    size_t           count;
+    std::string      path;
+    std::streambuf * err;
+    const char     * env;
+    
+    threads = ( argc > 1 ) ? static_cast< size_t >( strtoull( argv[ 1 ], nullptr, 10 ) ) : std::max< size_t >( 1, std::thread::hardware_concurrency() );
+    count   = ( argc > 2 ) ? static_cast< size_t >( strtoull( argv[ 2 ], nullptr, 10 ) ) : 200000;
+    path    = ( argc > 3 ) ? argv[ 3 ] : "ULog-Suite.log";
+    
+    env = getenv( "ULOG_BENCH_COUNTERS" );
+    
+    if( env != nullptr && std::string( env ) == "1" )
+    {
+        PerformanceCounters.Open();
+    }
+    
+    /* Every scenario but the stderr sink runs with a null console */
+    err = std::cerr.rdbuf( nullptr );
+    
+    Throughput( threads, count );
+    Disabled( count * 10 );
+    Construction( count );
+    History( count * 5 );
+    API( count );
+    
+    Sink( "null", count, []( ULog::Logger & ) {} );
+    Sink( "file", count, [ & ]( ULog::Logger & logger ) { logger.AddLogFile( path ); } );
+    
+    std::cerr.rdbuf( err );
+    
+    Sink( "stderr", count, []( ULog::Logger & ) {} );
+    
+    remove( path.c_str() );
+    
+    printf( "{\n    \"threads\": %zu,\n    \"count\": %zu,\n    \"benchmarks\":\n    [\n", threads, count );
+    
+    for( size_t i = 0; i < Results.size(); i++ )
+    {
+        printf
+        (
+            "        { \"name\": \"%s\", \"unit\": \"%s\", \"value\": %.3f, \"iterations\": %llu",
+            Results[ i ].name.c_str(),
+            Results[ i ].unit.c_str(),
+            Results[ i ].value,
+            static_cast< unsigned long long >( Results[ i ].iterations )
+        );
+        
+        if( PerformanceCounters.IsAvailable() )
+        {
+            const char * separator = "";
+            
+            printf( ", \"counters\": { " );
+            
+            for( size_t j = 0; j < Counters::Count; j++ )
+            {
+                if( Results[ i ].counters[ j ] >= 0 )
+                {
+                    printf( "%s\"%s\": %.3f", separator, Counters::GetName( j ), Results[ i ].counters[ j ] );
+                    
+                    separator = ", ";
+                }
+            }
+            
+            printf( " }" );
+        }
+        
+        printf( " }%s\n", ( i + 1 < Results.size() ) ? "," : "" );
+    }
+    
+    printf( "    ]\n}\n" );
+    
+    return EXIT_SUCCESS;
+}
@@ -60,9 +60,20 @@ typedef enum
 }
 ULog_Logger_DisplayOption;
 
+typedef enum
+{
+    ULog_Logger_FormatText      = 0,
+    ULog_Logger_FormatJSON      = 1,
+    ULog_Logger_FormatLogfmt    = 2
+}
+ULog_Logger_Format;
+
 ULOG_EXPORT uint64_t ULog_GetDisplayOptions( void );
 ULOG_EXPORT void     ULog_SetDisplayOptions( uint64_t opt );
 
+ULOG_EXPORT ULog_Logger_Format ULog_GetFormat( void );
+ULOG_EXPORT void               ULog_SetFormat( ULog_Logger_Format format );
+
 ULOG_EXPORT bool ULog_IsEnabled( void );
 ULOG_EXPORT void ULog_SetEnabled( bool value );
 
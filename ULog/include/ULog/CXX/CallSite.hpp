@@ -0,0 +1,128 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+/*!
+ * @header      CallSite.hpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#ifndef ULOG_CXX_CALL_SITE_H
+#define ULOG_CXX_CALL_SITE_H
+
+#include <ULog/Base.h>
+#include <ULog/CXX/Message.hpp>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+namespace ULog
+{
+    /*
+     * Static descriptor of a logging macro expansion, in the spirit of
+     * Linux's dynamic_debug. Sites are constant-initialized (no pimpl, so
+     * the constructor can be constexpr) and join the registry the first
+     * time they run; a disabled site then costs one relaxed load. The
+     * format is nullptr unless the macro was given a string literal, and
+     * the function is only known once the site has run.
+     */
+    class ULOG_EXPORT CallSite
+    {
+        public:
+            
+            constexpr CallSite( const char * file, unsigned int line, const char * function, Message::Level level, const char * format ):
+                _flags( FlagEnabled ),
+                _hits( 0 ),
+                _next( nullptr ),
+                _file( file ),
+                _line( line ),
+                _function( function ),
+                _level( level ),
+                _format( format )
+            {}
+            
+            const char   * GetFile( void )     const;
+            unsigned int   GetLine( void )     const;
+            const char   * GetFunction( void ) const;
+            Message::Level GetLevel( void )    const;
+            const char   * GetFormat( void )   const;
+            uint64_t       GetHits( void )     const;
+            bool           IsEnabled( void )   const;
+            void           SetEnabled( bool value );
+            
+            /* __func__ isn't a constant expression, so it is passed here */
+            bool Hit( const char * function )
+            {
+                int flags;
+                
+                flags = this->_flags.load( std::memory_order_relaxed );
+                
+                if( ( flags & FlagRegistered ) == 0 )
+                {
+                    flags = this->Register( function );
+                }
+                
+                if( ( flags & FlagEnabled ) == 0 )
+                {
+                    return false;
+                }
+                
+                this->_hits.fetch_add( 1, std::memory_order_relaxed );
+                
+                return true;
+            }
+            
+            /* Only sites that have run at least once are listed */
+            static std::vector< CallSite * > GetCallSites( void );
+            
+            /*
+             * Sites whose file ends with the given path, on the given line
+             * (0 for any). Also applies to sites that have not run yet.
+             */
+            static size_t SetEnabled( const std::string & file, unsigned int line, bool value );
+            
+        private:
+            
+            enum
+            {
+                FlagEnabled    = 1 << 0,
+                FlagRegistered = 1 << 1
+            };
+            
+            CallSite( const CallSite & o );
+            CallSite & operator =( const CallSite & o );
+            
+            int Register( const char * function );
+            
+            std::atomic< int >       _flags;
+            std::atomic< uint64_t >  _hits;
+            CallSite               * _next;
+            const char             * _file;
+            unsigned int             _line;
+            const char             * _function;
+            Message::Level           _level;
+            const char             * _format;
+    };
+}
+
+#endif /* ULOG_CXX_CALL_SITE_H */
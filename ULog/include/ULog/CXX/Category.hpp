@@ -0,0 +1,107 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+/*!
+ * @header      Category.hpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#ifndef ULOG_CXX_CATEGORY_H
+#define ULOG_CXX_CATEGORY_H
+
+#include <ULog/Base.h>
+#include <ULog/CXX/Message.hpp>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+namespace ULog
+{
+    /*
+     * Handle to a named, dot-separated category ("net.http" is a child of
+     * "net"). Categories live for the whole process, so a handle can be
+     * resolved once and kept; checking a level is then one relaxed load.
+     * A category without a level of its own follows its parent's, and the
+     * root category ("") accepts every level by default.
+     */
+    class ULOG_EXPORT Category
+    {
+        public:
+            
+            static std::vector< Category > GetCategories( void );
+            
+            /*
+             * A thread level can only make a thread more verbose: a level is
+             * enabled on a thread if either its category or its thread level
+             * enables it. It only applies to category checks (IsEnabled() and
+             * the ULogCategory* macros), not to the logger itself. Threads are
+             * identified as in Message::GetThreadID(), and a thread's level is
+             * reset when that thread exits.
+             */
+            static uint64_t       GetCurrentThreadID( void );
+            static bool           HasThreadLevel( uint64_t thread );
+            static Message::Level GetThreadLevel( uint64_t thread );
+            static void           SetThreadLevel( uint64_t thread, Message::Level level );
+            static void           ResetThreadLevel( uint64_t thread );
+            
+            Category( void );
+            Category( const std::string & name );
+            Category( const char * name );
+            
+            const char   * GetName( void )   const;
+            Category       GetParent( void ) const;
+            bool           HasLevel( void )  const;
+            void           SetLevel( Message::Level level );
+            void           ResetLevel( void );
+            
+            Message::Level GetLevel( void ) const
+            {
+                return this->_level->load( std::memory_order_relaxed );
+            }
+            
+            /*
+             * The second load is the most verbose thread level, so threads
+             * only need checking when one of them could enable the message.
+             */
+            bool IsEnabled( Message::Level level ) const
+            {
+                return level <= this->_level->load( std::memory_order_relaxed )
+                    || ( static_cast< int >( level ) <= this->_threads->load( std::memory_order_relaxed ) && IsEnabledForThread( level ) );
+            }
+            
+        private:
+            
+            struct Node;
+            
+            Category( Node * node );
+            
+            static bool IsEnabledForThread( Message::Level level );
+            
+            Node                          * _node;
+            std::atomic< Message::Level > * _level;
+            const std::atomic< int >      * _threads;
+    };
+}
+
+#endif /* ULOG_CXX_CATEGORY_H */
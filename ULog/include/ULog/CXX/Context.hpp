@@ -0,0 +1,91 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+/*!
+ * @header      Context.hpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#ifndef ULOG_CXX_CONTEXT_H
+#define ULOG_CXX_CONTEXT_H
+
+#include <ULog/Base.h>
+#include <string>
+#include <memory>
+#include <cstddef>
+
+namespace ULog
+{
+    /*
+     * Immutable set of diagnostic fields (request id, trace id, ...),
+     * attached to every message created while a ContextScope makes it
+     * current. Messages share it instead of copying the fields; a context
+     * can be passed to another thread and made current there.
+     */
+    class ULOG_EXPORT Context
+    {
+        public:
+            
+            static const size_t MaxFields  = 8;
+            static const size_t BufferSize = 512;
+            
+            static const char * const RequestID;
+            static const char * const TraceID;
+            static const char * const SpanID;
+            static const char * const Tenant;
+            
+            static Context GetCurrent( void );
+            
+            Context( void );
+            Context( const Context & o );
+            Context( Context && o );
+            
+            /* Copy of the parent with a field set; fields that don't fit are dropped */
+            Context( const Context & parent, const std::string & key, const std::string & value );
+            
+            ~Context( void );
+            
+            Context & operator =( Context o );
+            
+            friend void swap( Context & o1, Context & o2 );
+            
+            bool         IsEmpty( void )                    const;
+            size_t       GetCount( void )                   const;
+            const char * GetKey( size_t index )             const;
+            const char * GetValue( size_t index )           const;
+            const char * GetValue( const std::string & key ) const;
+            
+        private:
+            
+            friend class ContextScope;
+            
+            /* Returns the previous current context */
+            static const Context * SetCurrent( const Context * context );
+            
+            class IMPL;
+            
+            std::shared_ptr< const IMPL > impl;
+    };
+}
+
+#endif /* ULOG_CXX_CONTEXT_H */
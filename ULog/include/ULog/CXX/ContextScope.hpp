@@ -0,0 +1,63 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+/*!
+ * @header      ContextScope.hpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#ifndef ULOG_CXX_CONTEXT_SCOPE_H
+#define ULOG_CXX_CONTEXT_SCOPE_H
+
+#include <ULog/Base.h>
+#include <ULog/CXX/Context.hpp>
+#include <string>
+
+namespace ULog
+{
+    /*
+     * Makes a context current on the calling thread until destroyed, either
+     * the current one with a field set or one passed from another thread.
+     * Scopes nest, and must be destroyed on their own thread.
+     */
+    class ULOG_EXPORT ContextScope
+    {
+        public:
+            
+            ContextScope( const std::string & key, const std::string & value );
+            ContextScope( const Context & context );
+            
+            ~ContextScope( void );
+            
+        private:
+            
+            ContextScope( const ContextScope & o );
+            ContextScope & operator =( const ContextScope & o );
+            
+            class IMPL;
+            
+            IMPL * impl;
+    };
+}
+
+#endif /* ULOG_CXX_CONTEXT_SCOPE_H */
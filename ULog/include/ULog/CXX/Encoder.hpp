@@ -0,0 +1,62 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+/*!
+ * @header      Encoder.hpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#ifndef ULOG_CXX_ENCODER_H
+#define ULOG_CXX_ENCODER_H
+
+#include <ULog/Base.h>
+#include <ULog/CXX/Message.hpp>
+#include <string>
+#include <cstddef>
+
+namespace ULog
+{
+    class ULOG_EXPORT Encoder
+    {
+        public:
+            
+            static std::string EncodeJSON( const Message & msg );
+            static std::string EncodeLogfmt( const Message & msg );
+            
+            static void EncodeJSON( const Message & msg, std::string & out );
+            static void EncodeLogfmt( const Message & msg, std::string & out );
+            
+            static void AppendJSONString( std::string & out, const char * s, size_t length );
+            static void AppendLogfmtValue( std::string & out, const char * s, size_t length );
+            
+            static size_t FindJSONEscape( const char * s, size_t length );
+            static size_t FindLogfmtEscape( const char * s, size_t length );
+            
+        private:
+            
+            Encoder( void );
+    };
+}
+
+#endif /* ULOG_CXX_ENCODER_H */
@@ -0,0 +1,74 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+/*!
+ * @header      FlightRecorder.hpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#ifndef ULOG_CXX_FLIGHT_RECORDER_H
+#define ULOG_CXX_FLIGHT_RECORDER_H
+
+#include <ULog/Base.h>
+#include <ULog/CXX/Message.hpp>
+#include <vector>
+#include <cstddef>
+
+namespace ULog
+{
+    /*
+     * Fixed-size ring of the most recent messages. Writers claim a slot with
+     * an atomic increment and publish with an exchange, so adding is
+     * lock-free; only Drain() and copies serialize, with each other.
+     */
+    class ULOG_EXPORT FlightRecorder
+    {
+        public:
+            
+            FlightRecorder( size_t capacity );
+            FlightRecorder( const FlightRecorder & o );
+            FlightRecorder( FlightRecorder && o );
+            
+            ~FlightRecorder( void );
+            
+            FlightRecorder & operator =( FlightRecorder o );
+            
+            friend void swap( FlightRecorder & o1, FlightRecorder & o2 );
+            
+            size_t GetCapacity( void ) const;
+            
+            void Add( Message msg );
+            void Clear( void );
+            
+            /* Removes and returns the recorded messages, oldest first */
+            std::vector< Message > Drain( void );
+            
+        private:
+            
+            class IMPL;
+            
+            IMPL * impl;
+    };
+}
+
+#endif /* ULOG_CXX_FLIGHT_RECORDER_H */
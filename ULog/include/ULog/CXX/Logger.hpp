@@ -32,8 +32,14 @@
 
 #include <ULog/Base.h>
 #include <ULog/CXX/Message.hpp>
+#include <ULog/CXX/Statistics.hpp>
+#include <ULog/CXX/Metrics.hpp>
+#include <ULog/CXX/CallSite.hpp>
+#include <ULog/CXX/Category.hpp>
 #include <vector>
+#include <string>
 #include <cstdarg>
+#include <functional>
 
 namespace ULog
 {
@@ -50,6 +56,29 @@ namespace ULog
             }
             DisplayOption;
             
+            typedef enum
+            {
+                FormatText      = 0,
+                FormatJSON      = 1,
+                FormatLogfmt    = 2
+            }
+            Format;
+            
+            typedef enum
+            {
+                SearchOptionCaseInsensitive = 1 << 1
+            }
+            SearchOption;
+            
+            typedef enum
+            {
+                BackpressureBlock           = 0,
+                BackpressureDropNewest      = 1,
+                BackpressureDropOldest      = 2,
+                BackpressureDropBelowLevel  = 3
+            }
+            Backpressure;
+            
             static Logger * SharedInstance( void );
             
             Logger( void );
@@ -65,9 +94,65 @@ namespace ULog
             uint64_t GetDisplayOptions( void );
             void     SetDisplayOptions( uint64_t opt );
             
+            Format GetFormat( void );
+            void   SetFormat( Format format );
+            
             bool IsEnabled( void ) const;
             void SetEnabled( bool value );
             
+            size_t GetHistoryLimit( void ) const;
+            void   SetHistoryLimit( size_t limit );
+            
+            size_t GetScanThreads( void ) const;
+            void   SetScanThreads( size_t threads );
+            
+            uint64_t GetDeduplicationWindow( void ) const;
+            void     SetDeduplicationWindow( uint64_t milliseconds );
+            
+            uint64_t GetSampling( Message::Level level ) const;
+            uint64_t GetSampling( Message::Source source ) const;
+            void     SetSampling( Message::Level level, uint64_t n );
+            void     SetSampling( Message::Source source, uint64_t n );
+            
+            double GetRateLimit( Message::Level level ) const;
+            double GetRateLimit( Message::Source source ) const;
+            void   SetRateLimit( Message::Level level, double rate, double burst );
+            void   SetRateLimit( Message::Source source, double rate, double burst );
+            
+            size_t GetQueueCapacity( void ) const;
+            void   SetQueueCapacity( size_t capacity );
+            
+            Backpressure   GetBackpressure( void ) const;
+            void           SetBackpressure( Backpressure policy );
+            uint64_t       GetBackpressureTimeout( void ) const;
+            void           SetBackpressureTimeout( uint64_t milliseconds );
+            Message::Level GetBackpressureLevel( void ) const;
+            void           SetBackpressureLevel( Message::Level level );
+            
+            /* Messages at or above the priority level bypass the queue */
+            Message::Level GetPriorityLevel( void ) const;
+            void           SetPriorityLevel( Message::Level level );
+            bool           IsPrioritySyncEnabled( void ) const;
+            void           SetPrioritySyncEnabled( bool value );
+            
+            /*
+             * Messages below the flight recorder level only go to an in-memory
+             * ring of the given capacity (0 disables it), written to the sinks
+             * when a message at or above the trigger level is logged. They keep
+             * the sequence they were logged with, so GetMessagesSince() only
+             * returns them to readers that are not already past it.
+             */
+            size_t         GetFlightRecorderCapacity( void ) const;
+            Message::Level GetFlightRecorderLevel( void ) const;
+            void           SetFlightRecorder( size_t capacity, Message::Level level );
+            Message::Level GetFlightRecorderTrigger( void ) const;
+            void           SetFlightRecorderTrigger( Message::Level level );
+            void           DumpFlightRecorder( void );
+            
+            /* The signal dumps each logger's flight recorder on its next message */
+            static void SetFlightRecorderSignal( int signal );
+            
+            void Flush( void );
             void Clear( void );
             
             void AddLogFile( const std::string & path );
@@ -83,6 +168,14 @@ namespace ULog
             void Log( Message::Level level, const char * fmt, va_list ap )                          ULOG_ATTRIBUTE_FORMAT( 3, 0 );
             void Log( Message::Source source, Message::Level level, const char * fmt, ... )         ULOG_ATTRIBUTE_FORMAT( 4, 5 );
             void Log( Message::Source source, Message::Level level, const char * fmt, va_list ap )  ULOG_ATTRIBUTE_FORMAT( 4, 0 );
+            void Log( const CallSite & site, Message::Source source, const char * fmt, ... )       ULOG_ATTRIBUTE_FORMAT( 4, 5 );
+            void Log( const CallSite & site, Message::Source source, const char * fmt, va_list ap ) ULOG_ATTRIBUTE_FORMAT( 4, 0 );
+            
+            /* Messages below the category's level are discarded before formatting */
+            void Log( const Category & category, Message::Level level, const char * fmt, ... )                              ULOG_ATTRIBUTE_FORMAT( 4, 5 );
+            void Log( const Category & category, Message::Level level, const char * fmt, va_list ap )                       ULOG_ATTRIBUTE_FORMAT( 4, 0 );
+            void Log( const CallSite & site, const Category & category, Message::Source source, const char * fmt, ... )      ULOG_ATTRIBUTE_FORMAT( 5, 6 );
+            void Log( const CallSite & site, const Category & category, Message::Source source, const char * fmt, va_list ap ) ULOG_ATTRIBUTE_FORMAT( 5, 0 );
             
             void Emergency( const char * fmt, ... )                                 ULOG_ATTRIBUTE_FORMAT( 2, 3 );
             void Emergency( const char * fmt, va_list ap )                          ULOG_ATTRIBUTE_FORMAT( 2, 0 );
@@ -124,10 +217,28 @@ namespace ULog
             void Debug( Message::Source source, const char * fmt, ... )         ULOG_ATTRIBUTE_FORMAT( 3, 4 );
             void Debug( Message::Source source, const char * fmt, va_list ap )  ULOG_ATTRIBUTE_FORMAT( 3, 0 );
             
-            std::vector< Message > GetMessages( void ) const;
+            std::vector< Message >  GetMessages( void ) const;
+            std::vector< Message >  GetMessagesSince( uint64_t sequence, size_t max, uint64_t & next ) const;
+            uint64_t                GetLastSequence( void ) const;
+            Statistics              GetStatistics( void ) const;
+            Metrics                 GetMetrics( void ) const;
+            std::vector< uint64_t > Search( const std::string & query, uint64_t options ) const;
+            
+            /* Masks are bit sets of ( 1 << Message::Level ) and ( 1 << Message::Source ) */
+            std::vector< Message > GetMessages( const std::string & query, uint64_t options, uint64_t levelMask, uint64_t sourceMask ) const;
+            
+            /* Times are milliseconds since the epoch, from inclusive, to exclusive */
+            std::vector< Message > GetMessages( uint64_t from, uint64_t to ) const;
+            size_t                 CountMessages( uint64_t from, uint64_t to, uint64_t levelMask ) const;
+            void                   VisitMessages( uint64_t from, uint64_t to, std::function< void( const Message & ) > f ) const;
             
         private:
             
+            friend class RequestContext;
+            
+            void Ingest( Message msg );
+            void Discard( const Message & msg );
+            
             class IMPL;
             
             IMPL * impl;
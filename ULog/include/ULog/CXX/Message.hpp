@@ -31,10 +31,13 @@
 #define ULOG_CXX_MESSAGE_H
 
 #include <ULog/Base.h>
+#include <ULog/CXX/Context.hpp>
 #include <string>
 #include <iostream>
 #include <cstdarg>
 #include <cstdint>
+#include <vector>
+#include <utility>
 
 #ifdef __APPLE__
 #include <asl.h>
@@ -42,6 +45,8 @@
 
 namespace ULog
 {
+    class CallSite;
+    
     class ULOG_EXPORT Message
     {
         public:
@@ -70,6 +75,8 @@ namespace ULog
             }
             Level;
             
+            typedef std::pair< std::string, std::string > Field;
+            
             Message( Source = SourceCXX, Level level = LevelDebug, const std::string & message = "" );
             Message( Source source, Level level, const char * fmt, ... )        ULOG_ATTRIBUTE_FORMAT( 4, 5 );
             Message( Source source, Level level, const char * fmt, va_list ap ) ULOG_ATTRIBUTE_FORMAT( 4, 0 );
@@ -95,21 +102,45 @@ namespace ULog
             friend void swap( Message & o1, Message & o2 );
             friend std::ostream & operator <<( std::ostream & os, const Message & e );
             
-            Source      GetSource( void )        const;
-            Level       GetLevel( void )         const;
-            uint64_t    GetTime( void )          const;
-            uint64_t    GetMilliseconds( void )  const;
-            uint64_t    GetProcessID( void )     const;
-            uint64_t    GetThreadID( void )      const;
-            std::string GetSourceString( void )  const;
-            std::string GetLevelString( void )   const;
-            std::string GetTimeString( void )    const;
-            std::string GetProcessString( void ) const;
-            std::string GetMessage( void )       const;
-            std::string GetDescription( void )   const;
+            Source              GetSource( void )        const;
+            Level               GetLevel( void )         const;
+            uint64_t            GetTime( void )          const;
+            uint64_t            GetMilliseconds( void )  const;
+            uint64_t            GetProcessID( void )     const;
+            uint64_t            GetThreadID( void )      const;
+            uint64_t            GetSequence( void )      const;
+            std::string         GetSourceString( void )  const;
+            std::string         GetLevelString( void )   const;
+            std::string         GetTimeString( void )    const;
+            std::string         GetProcessString( void ) const;
+            std::string         GetMessage( void )       const;
+            std::string         GetDescription( void )   const;
+            
+            /* The message text without a copy, valid as long as the message */
+            const std::string & GetText( void ) const;
+            
+            std::vector< Field > GetFields( void ) const;
+            void                 AddField( const std::string & key, const std::string & value );
+            
+            void SetSequence( uint64_t sequence );
+            
+            /* Set by the ULog* macros; sites are static, so this is only a pointer */
+            const CallSite * GetCallSite( void ) const;
+            void             SetCallSite( const CallSite * site );
+            
+            /* The thread's current context when the message was created */
+            const Context & GetContext( void ) const;
+            void            SetContext( const Context & context );
+            
+            /* Name of the message's ULog::Category, nullptr if it has none */
+            const char * GetCategory( void ) const;
+            void         SetCategory( const char * name );
             
         private:
             
+            /* Only defined inside the library (source/CXX/CXX-Message-IMPL.hpp) */
+            friend class MessageAccess;
+            
             class IMPL;
             
             IMPL * impl;
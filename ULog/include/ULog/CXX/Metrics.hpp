@@ -0,0 +1,97 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+/*!
+ * @header      Metrics.hpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#ifndef ULOG_CXX_METRICS_H
+#define ULOG_CXX_METRICS_H
+
+#include <ULog/Base.h>
+#include <ULog/CXX/Message.hpp>
+#include <vector>
+#include <cstdint>
+
+namespace ULog
+{
+    class ULOG_EXPORT Metrics
+    {
+        public:
+            
+            typedef enum
+            {
+                StageAccepted = 0,
+                StageFiltered = 1,
+                StageDropped  = 2,
+                StageWritten  = 3
+            }
+            Stage;
+            
+            /* SinkFiles is an aggregate of every file added with AddLogFile() */
+            typedef enum
+            {
+                SinkConsole = 0,
+                SinkFiles   = 1
+            }
+            Sink;
+            
+            Metrics( void );
+            Metrics( const Metrics & o );
+            Metrics( Metrics && o );
+            
+            ~Metrics( void );
+            
+            Metrics & operator =( Metrics o );
+            
+            friend void swap( Metrics & o1, Metrics & o2 );
+            
+            void AddMessage( Stage stage, Message::Level level );
+            void AddWrite( Sink sink, uint64_t bytes, uint64_t nanoseconds );
+            void AddLockWait( uint64_t nanoseconds );
+            void SetQueueDepth( uint64_t depth );
+            
+            uint64_t GetMessages( Stage stage ) const;
+            uint64_t GetMessages( Stage stage, Message::Level level ) const;
+            uint64_t GetBytes( Sink sink ) const;
+            uint64_t GetWrites( Sink sink ) const;
+            uint64_t GetWriteTime( Sink sink ) const;
+            uint64_t GetQueueDepth( void ) const;
+            uint64_t GetQueueHighWaterMark( void ) const;
+            uint64_t GetLockWaits( void ) const;
+            uint64_t GetLockWaitTime( void ) const;
+            
+            /* Bucket i counts writes that took [ 2^i, 2^( i + 1 ) ) nanoseconds */
+            std::vector< uint64_t > GetLatencies( Sink sink ) const;
+            uint64_t                GetLatency( Sink sink, double percentile ) const;
+            
+        private:
+            
+            class IMPL;
+            
+            IMPL * impl;
+    };
+}
+
+#endif /* ULOG_CXX_METRICS_H */
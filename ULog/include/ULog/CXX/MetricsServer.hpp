@@ -0,0 +1,76 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+/*!
+ * @header      MetricsServer.hpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#ifndef ULOG_CXX_METRICS_SERVER_H
+#define ULOG_CXX_METRICS_SERVER_H
+
+#include <ULog/Base.h>
+#include <ULog/CXX/Logger.hpp>
+#include <string>
+#include <cstdint>
+
+namespace ULog
+{
+    /*
+     * Serves the logger's statistics and metrics in the Prometheus text
+     * format, over HTTP, from its own thread. The logger must outlive it.
+     * Scrapes are served one at a time, each client getting at most a
+     * second to send its request and another to read the response.
+     */
+    class ULOG_EXPORT MetricsServer
+    {
+        public:
+            
+            MetricsServer( const Logger & logger );
+            
+            ~MetricsServer( void );
+            
+            /* Loopback only; port 0 picks a free port (see GetPort) */
+            bool Start( uint16_t port );
+            
+            /* Unix domain socket, not available on Windows */
+            bool Start( const std::string & path );
+            
+            void Stop( void );
+            
+            bool        IsRunning( void ) const;
+            uint16_t    GetPort( void ) const;
+            std::string GetText( void ) const;
+            
+        private:
+            
+            MetricsServer( const MetricsServer & o );
+            MetricsServer & operator =( const MetricsServer & o );
+            
+            class IMPL;
+            
+            IMPL * impl;
+    };
+}
+
+#endif /* ULOG_CXX_METRICS_SERVER_H */
@@ -0,0 +1,94 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+/*!
+ * @header      RequestContext.hpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#ifndef ULOG_CXX_REQUEST_CONTEXT_H
+#define ULOG_CXX_REQUEST_CONTEXT_H
+
+#include <ULog/Base.h>
+#include <ULog/CXX/Message.hpp>
+#include <memory>
+#include <cstddef>
+
+namespace ULog
+{
+    class Logger;
+    
+    /*
+     * Buffers the verbose messages logged for one request, on every thread
+     * where a RequestScope makes it current. The buffer is written to the
+     * logger once an error is logged or the request is marked as failed,
+     * and discarded otherwise. Copies share the same request.
+     */
+    class ULOG_EXPORT RequestContext
+    {
+        public:
+            
+            RequestContext( void );
+            RequestContext( Logger & logger );
+            RequestContext( const RequestContext & o );
+            RequestContext( RequestContext && o );
+            
+            ~RequestContext( void );
+            
+            RequestContext & operator =( RequestContext o );
+            
+            friend void swap( RequestContext & o1, RequestContext & o2 );
+            
+            static RequestContext * GetCurrent( void );
+            
+            /* Messages at or below the level (Info by default) are buffered */
+            Message::Level GetLevel( void ) const;
+            void           SetLevel( Message::Level level );
+            
+            /* Oldest messages are dropped past the capacity */
+            size_t GetCapacity( void ) const;
+            void   SetCapacity( size_t capacity );
+            
+            size_t GetCount( void ) const;
+            bool   IsFailed( void ) const;
+            void   MarkFailed( void );
+            
+            /* Discards the buffer (as DropDiscarded), also done when the last copy is destroyed */
+            void Finish( void );
+            
+        private:
+            
+            friend class Logger;
+            friend class RequestScope;
+            
+            static void SetCurrent( RequestContext * context );
+            
+            bool Buffer( Logger & logger, const Message & msg );
+            
+            class IMPL;
+            
+            std::shared_ptr< IMPL > impl;
+    };
+}
+
+#endif /* ULOG_CXX_REQUEST_CONTEXT_H */
@@ -0,0 +1,82 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+/*!
+ * @header      SearchIndex.hpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#ifndef ULOG_CXX_SEARCH_INDEX_H
+#define ULOG_CXX_SEARCH_INDEX_H
+
+#include <ULog/Base.h>
+#include <ULog/CXX/Message.hpp>
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+namespace ULog
+{
+    class ULOG_EXPORT SearchIndex
+    {
+        public:
+            
+            /*
+             * ( time in milliseconds, sequence ): the order of the logger's
+             * history.
+             */
+            typedef std::pair< uint64_t, uint64_t > Key;
+            
+            static const size_t MinimumQueryLength = 3;
+            
+            static Key GetKey( const Message & msg );
+            
+            SearchIndex( void );
+            SearchIndex( const SearchIndex & o );
+            SearchIndex( SearchIndex && o );
+            
+            ~SearchIndex( void );
+            
+            SearchIndex & operator =( SearchIndex o );
+            
+            friend void swap( SearchIndex & o1, SearchIndex & o2 );
+            
+            bool   Add( const Message & msg );
+            void   Remove( const Message & msg );
+            void   Clear( void );
+            size_t GetCount( void ) const;
+            
+            std::vector< Key > GetCandidates( const std::string & query ) const;
+            
+        private:
+            
+            class IMPL;
+            
+            IMPL * impl;
+    };
+}
+
+#endif /* ULOG_CXX_SEARCH_INDEX_H */
@@ -0,0 +1,95 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+/*!
+ * @header      Statistics.hpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#ifndef ULOG_CXX_STATISTICS_H
+#define ULOG_CXX_STATISTICS_H
+
+#include <ULog/Base.h>
+#include <ULog/CXX/Message.hpp>
+#include <vector>
+#include <cstdint>
+
+namespace ULog
+{
+    /*
+     * Counters are atomics: Add and AddDrop need no external lock, and the
+     * logger calls them both under its lock and outside of it.
+     */
+    class ULOG_EXPORT Statistics
+    {
+        public:
+            
+            typedef enum
+            {
+                DropSampled     = 0,
+                DropRateLimited = 1,
+                DropNewest      = 2,
+                DropOldest      = 3,
+                DropBelowLevel  = 4,
+                DropTimeout     = 5,
+                DropDiscarded   = 6
+            }
+            Drop;
+            
+            Statistics( void );
+            Statistics( const Statistics & o );
+            Statistics( Statistics && o );
+            
+            ~Statistics( void );
+            
+            Statistics & operator =( Statistics o );
+            
+            friend void swap( Statistics & o1, Statistics & o2 );
+            
+            void Add( const Message & msg );
+            void AddDrop( Drop reason, Message::Level level );
+            
+            uint64_t GetTime( void ) const;
+            uint64_t GetCount( void ) const;
+            uint64_t GetCount( Message::Level level ) const;
+            uint64_t GetCount( Message::Source source ) const;
+            uint64_t GetDrops( Drop reason ) const;
+            uint64_t GetDrops( Drop reason, Message::Level level ) const;
+            uint64_t GetCountInLastMinute( uint64_t levelMask ) const;
+            uint64_t GetCountInLastHour( uint64_t levelMask ) const;
+            double   GetRatePerSecond( uint64_t levelMask ) const;
+            double   GetRatePerMinute( uint64_t levelMask ) const;
+            
+            std::vector< uint64_t > GetSeconds( uint64_t levelMask ) const;
+            std::vector< uint64_t > GetMinutes( uint64_t levelMask ) const;
+            
+        private:
+            
+            class IMPL;
+            
+            IMPL * impl;
+    };
+}
+
+#endif /* ULOG_CXX_STATISTICS_H */
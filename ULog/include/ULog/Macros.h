@@ -56,15 +56,43 @@
 
 #elif defined( __cplusplus )
 
-#define ULog( ... )             ULog::Logger::SharedInstance()->Log( ULog::Message::SourceCXX, ULog::Message::LevelDebug, __VA_ARGS__ )
-#define ULogEmergency( ... )    ULog::Logger::SharedInstance()->Emergency( ULog::Message::SourceCXX, __VA_ARGS__ )
-#define ULogAlert( ... )        ULog::Logger::SharedInstance()->Alert( ULog::Message::SourceCXX, __VA_ARGS__ )
-#define ULogCritical( ... )     ULog::Logger::SharedInstance()->Critical( ULog::Message::SourceCXX, __VA_ARGS__ )
-#define ULogError( ... )        ULog::Logger::SharedInstance()->Error( ULog::Message::SourceCXX, __VA_ARGS__ )
-#define ULogWarning( ... )      ULog::Logger::SharedInstance()->Warning( ULog::Message::SourceCXX, __VA_ARGS__ )
-#define ULogNotice( ... )       ULog::Logger::SharedInstance()->Notice( ULog::Message::SourceCXX, __VA_ARGS__ )
-#define ULogInfo( ... )         ULog::Logger::SharedInstance()->Info( ULog::Message::SourceCXX, __VA_ARGS__ )
-#define ULogDebug( ... )        ULog::Logger::SharedInstance()->Debug( ULog::Message::SourceCXX, __VA_ARGS__ )      
+/*
+ * Each expansion owns a static ULog::CallSite (file, line, function, level,
+ * format), which can be listed and toggled at runtime. The lambda keeps the
+ * macros usable as expressions, as they were before call sites.
+ */
+#define ULOG_EXPAND( _x_ )              _x_
+#define ULOG_FIRST_( _x_, ... )         _x_
+#define ULOG_FIRST( ... )               ULOG_EXPAND( ULOG_FIRST_( __VA_ARGS__, 0 ) )
+
+/* Sites outlive the call: only a string literal can be kept as the format */
+#if defined( __GNUC__ ) || defined( __clang__ )
+#define ULOG_LITERAL( _s_ )             ( __builtin_constant_p( _s_ ) ? ( _s_ ) : nullptr )
+#else
+#define ULOG_LITERAL( _s_ )             nullptr
+#endif
+
+#define ULOG_SITE( _level_, ... )                                                                                               \
+    [ & ]( const char * ULogFunction )                                                                                          \
+    {                                                                                                                           \
+        static ULog::CallSite ULogCallSite( __FILE__, __LINE__, nullptr, _level_, ULOG_LITERAL( ULOG_FIRST( __VA_ARGS__ ) ) );  \
+                                                                                                                                \
+        if( ULogCallSite.Hit( ULogFunction ) )                                                                                  \
+        {                                                                                                                       \
+            ULog::Logger::SharedInstance()->Log( ULogCallSite, ULog::Message::SourceCXX, __VA_ARGS__ );                         \
+        }                                                                                                                       \
+    }                                                                                                                           \
+    ( __func__ )
+
+#define ULog( ... )             ULOG_SITE( ULog::Message::LevelDebug,     __VA_ARGS__ )
+#define ULogEmergency( ... )    ULOG_SITE( ULog::Message::LevelEmergency, __VA_ARGS__ )
+#define ULogAlert( ... )        ULOG_SITE( ULog::Message::LevelAlert,     __VA_ARGS__ )
+#define ULogCritical( ... )     ULOG_SITE( ULog::Message::LevelCritical,  __VA_ARGS__ )
+#define ULogError( ... )        ULOG_SITE( ULog::Message::LevelError,     __VA_ARGS__ )
+#define ULogWarning( ... )      ULOG_SITE( ULog::Message::LevelWarning,   __VA_ARGS__ )
+#define ULogNotice( ... )       ULOG_SITE( ULog::Message::LevelNotice,    __VA_ARGS__ )
+#define ULogInfo( ... )         ULOG_SITE( ULog::Message::LevelInfo,      __VA_ARGS__ )
+#define ULogDebug( ... )        ULOG_SITE( ULog::Message::LevelDebug,     __VA_ARGS__ )
 
 #elif defined( __OBJC__ )
 
@@ -92,6 +120,66 @@
 
 #endif
 
+#if defined( ULOG_DISABLE ) && ULOG_DISABLE == 1
+
+#define ULogCategory( _category_, ... )             
+#define ULogCategoryEmergency( _category_, ... )    
+#define ULogCategoryAlert( _category_, ... )        
+#define ULogCategoryCritical( _category_, ... )     
+#define ULogCategoryError( _category_, ... )        
+#define ULogCategoryWarning( _category_, ... )      
+#define ULogCategoryNotice( _category_, ... )       
+#define ULogCategoryInfo( _category_, ... )         
+#define ULogCategoryDebug( _category_, ... )        
+
+#elif defined( __cplusplus ) && !defined( __OBJC__ )
+
+/*
+ * The category (a ULog::Category or its name) is resolved once per
+ * expansion; below its level, a call costs one comparison.
+ */
+#define ULOG_CATEGORY_SITE( _category_, _level_, ... )                                                                              \
+    [ & ]( const char * ULogFunction )                                                                                              \
+    {                                                                                                                               \
+        static const ULog::Category ULogCategoryHandle( _category_ );                                                               \
+                                                                                                                                    \
+        if( ULogCategoryHandle.IsEnabled( _level_ ) )                                                                               \
+        {                                                                                                                           \
+            static ULog::CallSite ULogCallSite( __FILE__, __LINE__, nullptr, _level_, ULOG_LITERAL( ULOG_FIRST( __VA_ARGS__ ) ) );  \
+                                                                                                                                    \
+            if( ULogCallSite.Hit( ULogFunction ) )                                                                                  \
+            {                                                                                                                       \
+                ULog::Logger::SharedInstance()->Log( ULogCallSite, ULogCategoryHandle, ULog::Message::SourceCXX, __VA_ARGS__ );     \
+            }                                                                                                                       \
+        }                                                                                                                           \
+    }                                                                                                                               \
+    ( __func__ )
+
+#define ULogCategory( _category_, ... )             ULOG_CATEGORY_SITE( _category_, ULog::Message::LevelDebug,     __VA_ARGS__ )
+#define ULogCategoryEmergency( _category_, ... )    ULOG_CATEGORY_SITE( _category_, ULog::Message::LevelEmergency, __VA_ARGS__ )
+#define ULogCategoryAlert( _category_, ... )        ULOG_CATEGORY_SITE( _category_, ULog::Message::LevelAlert,     __VA_ARGS__ )
+#define ULogCategoryCritical( _category_, ... )     ULOG_CATEGORY_SITE( _category_, ULog::Message::LevelCritical,  __VA_ARGS__ )
+#define ULogCategoryError( _category_, ... )        ULOG_CATEGORY_SITE( _category_, ULog::Message::LevelError,     __VA_ARGS__ )
+#define ULogCategoryWarning( _category_, ... )      ULOG_CATEGORY_SITE( _category_, ULog::Message::LevelWarning,   __VA_ARGS__ )
+#define ULogCategoryNotice( _category_, ... )       ULOG_CATEGORY_SITE( _category_, ULog::Message::LevelNotice,    __VA_ARGS__ )
+#define ULogCategoryInfo( _category_, ... )         ULOG_CATEGORY_SITE( _category_, ULog::Message::LevelInfo,      __VA_ARGS__ )
+#define ULogCategoryDebug( _category_, ... )        ULOG_CATEGORY_SITE( _category_, ULog::Message::LevelDebug,     __VA_ARGS__ )
+
+#else
+
+/* Categories are C++ only; elsewhere they are ignored */
+#define ULogCategory( _category_, ... )             ULog( __VA_ARGS__ )
+#define ULogCategoryEmergency( _category_, ... )    ULogEmergency( __VA_ARGS__ )
+#define ULogCategoryAlert( _category_, ... )        ULogAlert( __VA_ARGS__ )
+#define ULogCategoryCritical( _category_, ... )     ULogCritical( __VA_ARGS__ )
+#define ULogCategoryError( _category_, ... )        ULogError( __VA_ARGS__ )
+#define ULogCategoryWarning( _category_, ... )      ULogWarning( __VA_ARGS__ )
+#define ULogCategoryNotice( _category_, ... )       ULogNotice( __VA_ARGS__ )
+#define ULogCategoryInfo( _category_, ... )         ULogInfo( __VA_ARGS__ )
+#define ULogCategoryDebug( _category_, ... )        ULogDebug( __VA_ARGS__ )
+
+#endif
+
 #if defined( __clang__ )
 #define ULOG_ATTRIBUTE_FORMAT( _f_, _v_ )   __attribute__( ( __format__ ( __printf__, _f_, _v_ ) ) )
 #else
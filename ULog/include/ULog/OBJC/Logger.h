@@ -47,14 +47,24 @@ typedef enum
 }
 ULog_Logger_DisplayOption;
 
+typedef enum
+{
+    ULogLoggerSearchOptionCaseInsensitive = 1 << 1
+}
+ULog_Logger_SearchOption;
+
 @interface ULogLogger: NSObject
 
 @property( atomic, readwrite, assign, getter = isEnabled ) BOOL                       enabled;
 @property( atomic, readwrite, assign                     ) uint64_t                   displayOptions;
+@property( atomic, readwrite, assign                     ) NSUInteger                 historyLimit;
 @property( atomic, readonly                              ) NSArray< ULogMessage * > * messages;
 
 + ( instancetype )sharedInstance;
 
+- ( NSArray< ULogMessage * > * )messagesSince: ( uint64_t )sequence limit: ( NSUInteger )limit next: ( uint64_t * )next;
+- ( NSArray< NSNumber * > * )search: ( NSString * )query options: ( uint64_t )options;
+
 - ( void )clear;
 - ( void )addLogFile: ( NSString * )path;
 - ( void )addASLSender: ( NSString * )sender;
@@ -75,6 +75,7 @@ ULogMessageLevel;
 @property( atomic, readonly ) uint64_t          milliseconds;
 @property( atomic, readonly ) uint64_t          processID;
 @property( atomic, readonly ) uint64_t          threadID;
+@property( atomic, readonly ) uint64_t          sequence;
 @property( atomic, readonly ) NSDate          * date;
 
 #ifdef __cplusplus
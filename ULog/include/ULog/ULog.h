@@ -37,6 +37,12 @@
 #include <ULog/CXX/Log.hpp>
 #include <ULog/CXX/Message.hpp>
 #include <ULog/CXX/Logger.hpp>
+#include <ULog/CXX/Encoder.hpp>
+#include <ULog/CXX/MetricsServer.hpp>
+#include <ULog/CXX/RequestContext.hpp>
+#include <ULog/CXX/RequestScope.hpp>
+#include <ULog/CXX/ContextScope.hpp>
+#include <ULog/CXX/Category.hpp>
 #endif
 
 /* Objective-C API */
@@ -106,6 +106,44 @@ void ULog_SetDisplayOptions( uint64_t opt )
     logger->SetDisplayOptions( o );
 }
 
+ULog_Logger_Format ULog_GetFormat( void )
+{
+    ULog::Logger * logger;
+    
+    logger = ULog::Logger::SharedInstance();
+    
+    if( logger == NULL )
+    {
+        return ULog_Logger_FormatText;
+    }
+    
+    switch( logger->GetFormat() )
+    {
+        case ULog::Logger::FormatJSON:      return ULog_Logger_FormatJSON;
+        case ULog::Logger::FormatLogfmt:    return ULog_Logger_FormatLogfmt;
+        default:                            return ULog_Logger_FormatText;
+    }
+}
+
+void ULog_SetFormat( ULog_Logger_Format format )
+{
+    ULog::Logger * logger;
+    
+    logger = ULog::Logger::SharedInstance();
+    
+    if( logger == NULL )
+    {
+        return;
+    }
+    
+    switch( format )
+    {
+        case ULog_Logger_FormatJSON:    logger->SetFormat( ULog::Logger::FormatJSON );   break;
+        case ULog_Logger_FormatLogfmt:  logger->SetFormat( ULog::Logger::FormatLogfmt ); break;
+        default:                        logger->SetFormat( ULog::Logger::FormatText );   break;
+    }
+}
+
 bool ULog_IsEnabled( void )
 {
     ULog::Logger * logger;
@@ -0,0 +1,222 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+/*!
+ * @file        CXX-CallSite.cpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#include <ULog/ULog.h>
+#include <ULog/CXX/CallSite.hpp>
+#include <mutex>
+#include <algorithm>
+#include <cstring>
+
+namespace ULog
+{
+    namespace
+    {
+        typedef struct
+        {
+            std::string  file;
+            unsigned int line;
+            bool         enabled;
+        }
+        Rule;
+        
+        typedef struct
+        {
+            std::mutex          mtx;
+            CallSite          * head;
+            std::vector< Rule > rules;
+        }
+        Registry;
+        
+        /* Sites may register during static initialization of other units */
+        Registry & GetRegistry( void )
+        {
+            static Registry * registry = new Registry();
+            
+            return *( registry );
+        }
+        
+        bool Matches( const Rule & rule, const char * file, unsigned int line )
+        {
+            size_t length;
+            
+            length = strlen( file );
+            
+            if( rule.line != 0 && rule.line != line )
+            {
+                return false;
+            }
+            
+            return rule.file.length() <= length && rule.file.compare( 0, std::string::npos, file + length - rule.file.length() ) == 0;
+        }
+    }
+    
+    const char * CallSite::GetFile( void ) const
+    {
+        return this->_file;
+    }
+    
+    unsigned int CallSite::GetLine( void ) const
+    {
+        return this->_line;
+    }
+    
+    const char * CallSite::GetFunction( void ) const
+    {
+        return this->_function;
+    }
+    
+    Message::Level CallSite::GetLevel( void ) const
+    {
+        return this->_level;
+    }
+    
+    const char * CallSite::GetFormat( void ) const
+    {
+        return this->_format;
+    }
+    
+    uint64_t CallSite::GetHits( void ) const
+    {
+        return this->_hits.load( std::memory_order_relaxed );
+    }
+    
+    bool CallSite::IsEnabled( void ) const
+    {
+        return ( this->_flags.load( std::memory_order_relaxed ) & FlagEnabled ) != 0;
+    }
+    
+    void CallSite::SetEnabled( bool value )
+    {
+        if( value )
+        {
+            this->_flags.fetch_or( FlagEnabled, std::memory_order_relaxed );
+        }
+        else
+        {
+            this->_flags.fetch_and( ~FlagEnabled, std::memory_order_relaxed );
+        }
+    }
+    
+    std::vector< CallSite * > CallSite::GetCallSites( void )
+    {
+        Registry                    & registry( GetRegistry() );
+        std::lock_guard< std::mutex > l( registry.mtx );
+        std::vector< CallSite * >     sites;
+        
+        for( CallSite * site = registry.head; site != nullptr; site = site->_next )
+        {
+            sites.push_back( site );
+        }
+        
+        return sites;
+    }
+    
+    size_t CallSite::SetEnabled( const std::string & file, unsigned int line, bool value )
+    {
+        Registry                    & registry( GetRegistry() );
+        std::lock_guard< std::mutex > l( registry.mtx );
+        Rule                          rule;
+        size_t                        n;
+        
+        rule.file    = file;
+        rule.line    = line;
+        rule.enabled = value;
+        n            = 0;
+        
+        /* Toggling the same sites again replaces their rule, so rules don't pile up */
+        registry.rules.erase
+        (
+            std::remove_if
+            (
+                registry.rules.begin(),
+                registry.rules.end(),
+                [ & ]( const Rule & r ) -> bool
+                {
+                    return r.file == file && r.line == line;
+                }
+            ),
+            registry.rules.end()
+        );
+        
+        registry.rules.push_back( rule );
+        
+        for( CallSite * site = registry.head; site != nullptr; site = site->_next )
+        {
+            if( Matches( rule, site->_file, site->_line ) )
+            {
+                site->SetEnabled( value );
+                
+                n++;
+            }
+        }
+        
+        return n;
+    }
+    
+    int CallSite::Register( const char * function )
+    {
+        Registry                    & registry( GetRegistry() );
+        std::lock_guard< std::mutex > l( registry.mtx );
+        const Rule                  * match;
+        int                           flags;
+        
+        flags = this->_flags.load( std::memory_order_relaxed );
+        
+        if( flags & FlagRegistered )
+        {
+            return flags;
+        }
+        
+        match = nullptr;
+        
+        /* Later rules win */
+        for( const auto & rule: registry.rules )
+        {
+            if( Matches( rule, this->_file, this->_line ) )
+            {
+                match = &rule;
+            }
+        }
+        
+        /* Read-modify-writes, so a concurrent SetEnabled() on the site isn't overwritten */
+        if( match != nullptr )
+        {
+            this->SetEnabled( match->enabled );
+        }
+        
+        if( this->_function == nullptr )
+        {
+            this->_function = function;
+        }
+        
+        this->_next   = registry.head;
+        registry.head = this;
+        
+        return this->_flags.fetch_or( FlagRegistered, std::memory_order_relaxed ) | FlagRegistered;
+    }
+}
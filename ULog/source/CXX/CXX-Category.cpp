@@ -0,0 +1,293 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+/*!
+ * @file        CXX-Category.cpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#include <ULog/ULog.h>
+#include <ULog/CXX/Category.hpp>
+#include "CXX-Message-IMPL.hpp"
+#include <mutex>
+#include <map>
+#include <limits>
+#include <algorithm>
+
+namespace ULog
+{
+    namespace
+    {
+        /* Most verbose thread level, -1 if there is none */
+        std::atomic< int >      ThreadLevelMax( -1 );
+        std::atomic< uint64_t > ThreadGeneration( 0 );
+        
+        /* Thread IDs are reused: a thread's own level is reset when it exits */
+        struct ThreadCache
+        {
+            uint64_t generation;
+            uint64_t thread;
+            int      level;
+            
+            ~ThreadCache( void )
+            {
+                if( this->thread != 0 && ThreadLevelMax.load( std::memory_order_relaxed ) >= 0 )
+                {
+                    Category::ResetThreadLevel( this->thread );
+                }
+                
+                this->thread = 0;
+            }
+        };
+        
+        thread_local ThreadCache CurrentThread = { std::numeric_limits< uint64_t >::max(), 0, -1 };
+        
+        std::map< uint64_t, Message::Level > & GetThreadLevels( void )
+        {
+            static std::map< uint64_t, Message::Level > * levels = new std::map< uint64_t, Message::Level >();
+            
+            return *( levels );
+        }
+        
+        void UpdateThreadLevels( void )
+        {
+            int max;
+            
+            max = -1;
+            
+            for( const auto & p: GetThreadLevels() )
+            {
+                max = std::max( max, static_cast< int >( p.second ) );
+            }
+            
+            ThreadLevelMax.store( max, std::memory_order_relaxed );
+            ThreadGeneration.fetch_add( 1, std::memory_order_release );
+        }
+    }
+    
+    /* Nodes are never freed, so handles and names stay valid */
+    struct Category::Node
+    {
+        std::string                   name;
+        Node                        * parent;
+        std::vector< Node * >         children;
+        std::atomic< Message::Level > level;
+        bool                          own;
+        
+        static std::mutex                      & GetMutex( void );
+        static std::map< std::string, Node * > & GetNodes( void );
+        static Node                            * Find( const std::string & name );
+        
+        void Propagate( Message::Level value );
+    };
+    
+    std::vector< Category > Category::GetCategories( void )
+    {
+        std::lock_guard< std::mutex > l( Node::GetMutex() );
+        std::vector< Category >       categories;
+        
+        for( const auto & p: Node::GetNodes() )
+        {
+            categories.push_back( Category( p.second ) );
+        }
+        
+        return categories;
+    }
+    
+    /* Also the source of the messages' thread IDs, computed once per thread */
+    uint64_t Category::GetCurrentThreadID( void )
+    {
+        if( CurrentThread.thread == 0 )
+        {
+            CurrentThread.thread = MessageAccess::IMPL::GetCurrentThreadID();
+        }
+        
+        return CurrentThread.thread;
+    }
+    
+    bool Category::HasThreadLevel( uint64_t thread )
+    {
+        std::lock_guard< std::mutex > l( Node::GetMutex() );
+        
+        return GetThreadLevels().count( thread ) != 0;
+    }
+    
+    Message::Level Category::GetThreadLevel( uint64_t thread )
+    {
+        std::lock_guard< std::mutex > l( Node::GetMutex() );
+        
+        auto it = GetThreadLevels().find( thread );
+        
+        return ( it == GetThreadLevels().end() ) ? Message::LevelEmergency : it->second;
+    }
+    
+    void Category::SetThreadLevel( uint64_t thread, Message::Level level )
+    {
+        std::lock_guard< std::mutex > l( Node::GetMutex() );
+        
+        GetThreadLevels()[ thread ] = level;
+        
+        UpdateThreadLevels();
+    }
+    
+    void Category::ResetThreadLevel( uint64_t thread )
+    {
+        std::lock_guard< std::mutex > l( Node::GetMutex() );
+        
+        if( GetThreadLevels().erase( thread ) != 0 )
+        {
+            UpdateThreadLevels();
+        }
+    }
+    
+    Category::Category( void ): Category( std::string() )
+    {}
+    
+    Category::Category( const std::string & name ): _node( nullptr ), _level( nullptr ), _threads( &ThreadLevelMax )
+    {
+        std::lock_guard< std::mutex > l( Node::GetMutex() );
+        
+        this->_node  = Node::Find( name );
+        this->_level = &( this->_node->level );
+    }
+    
+    Category::Category( const char * name ): Category( std::string( ( name == nullptr ) ? "" : name ) )
+    {}
+    
+    Category::Category( Node * node ): _node( node ), _level( &( node->level ) ), _threads( &ThreadLevelMax )
+    {}
+    
+    const char * Category::GetName( void ) const
+    {
+        return this->_node->name.c_str();
+    }
+    
+    Category Category::GetParent( void ) const
+    {
+        return Category( ( this->_node->parent == nullptr ) ? this->_node : this->_node->parent );
+    }
+    
+    bool Category::HasLevel( void ) const
+    {
+        std::lock_guard< std::mutex > l( Node::GetMutex() );
+        
+        return this->_node->own;
+    }
+    
+    void Category::SetLevel( Message::Level level )
+    {
+        std::lock_guard< std::mutex > l( Node::GetMutex() );
+        
+        this->_node->own = true;
+        
+        this->_node->Propagate( level );
+    }
+    
+    void Category::ResetLevel( void )
+    {
+        std::lock_guard< std::mutex > l( Node::GetMutex() );
+        
+        this->_node->own = false;
+        
+        this->_node->Propagate( ( this->_node->parent == nullptr ) ? Message::LevelDebug : this->_node->parent->level.load() );
+    }
+    
+    bool Category::IsEnabledForThread( Message::Level level )
+    {
+        uint64_t generation;
+        
+        generation = ThreadGeneration.load( std::memory_order_acquire );
+        
+        if( CurrentThread.generation != generation )
+        {
+            std::lock_guard< std::mutex > l( Node::GetMutex() );
+            
+            auto it = GetThreadLevels().find( GetCurrentThreadID() );
+            
+            CurrentThread.level      = ( it == GetThreadLevels().end() ) ? -1 : static_cast< int >( it->second );
+            CurrentThread.generation = ThreadGeneration.load( std::memory_order_relaxed );
+        }
+        
+        return static_cast< int >( level ) <= CurrentThread.level;
+    }
+    
+    /* Categories may be created during static initialization of other units */
+    std::mutex & Category::Node::GetMutex( void )
+    {
+        static std::mutex * mtx = new std::mutex();
+        
+        return *( mtx );
+    }
+    
+    std::map< std::string, Category::Node * > & Category::Node::GetNodes( void )
+    {
+        static std::map< std::string, Node * > * nodes = new std::map< std::string, Node * >();
+        
+        return *( nodes );
+    }
+    
+    Category::Node * Category::Node::Find( const std::string & name )
+    {
+        std::map< std::string, Node * > & nodes( GetNodes() );
+        Node                             * node;
+        size_t                             dot;
+        
+        auto it = nodes.find( name );
+        
+        if( it != nodes.end() )
+        {
+            return it->second;
+        }
+        
+        node = new Node;
+        dot  = name.rfind( '.' );
+        
+        node->name   = name;
+        node->parent = ( name.length() == 0 ) ? nullptr : Find( ( dot == std::string::npos ) ? std::string() : name.substr( 0, dot ) );
+        node->own    = false;
+        
+        node->level.store( ( node->parent == nullptr ) ? Message::LevelDebug : node->parent->level.load(), std::memory_order_relaxed );
+        
+        if( node->parent != nullptr )
+        {
+            node->parent->children.push_back( node );
+        }
+        
+        nodes[ name ] = node;
+        
+        return node;
+    }
+    
+    void Category::Node::Propagate( Message::Level value )
+    {
+        this->level.store( value, std::memory_order_relaxed );
+        
+        for( Node * child: this->children )
+        {
+            if( child->own == false )
+            {
+                child->Propagate( value );
+            }
+        }
+    }
+}
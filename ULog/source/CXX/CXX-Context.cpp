@@ -0,0 +1,212 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+/*!
+ * @file        CXX-Context.cpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#include <ULog/ULog.h>
+#include <ULog/CXX/Context.hpp>
+#include <cstring>
+#include <cstdint>
+
+namespace ULog
+{
+    namespace
+    {
+        thread_local const Context * CurrentContext = nullptr;
+    }
+    
+    /* Fields are NUL terminated strings in a fixed buffer, found by offset */
+    class Context::IMPL
+    {
+        public:
+            
+            IMPL( void );
+            
+            ~IMPL( void );
+            
+            char     _buffer[ BufferSize ];
+            uint16_t _keys[ MaxFields ];
+            uint16_t _values[ MaxFields ];
+            size_t   _count;
+            size_t   _used;
+            
+            void Append( const char * key, size_t keyLength, const char * value, size_t valueLength );
+    };
+    
+    const size_t Context::MaxFields;
+    const size_t Context::BufferSize;
+    
+    const char * const Context::RequestID = "request_id";
+    const char * const Context::TraceID   = "trace_id";
+    const char * const Context::SpanID    = "span_id";
+    const char * const Context::Tenant    = "tenant";
+    
+    Context Context::GetCurrent( void )
+    {
+        return ( CurrentContext == nullptr ) ? Context() : *( CurrentContext );
+    }
+    
+    const Context * Context::SetCurrent( const Context * context )
+    {
+        const Context * previous;
+        
+        previous       = CurrentContext;
+        CurrentContext = context;
+        
+        return previous;
+    }
+    
+    Context::Context( void )
+    {}
+    
+    Context::Context( const Context & o ): impl( o.impl )
+    {}
+    
+    Context::Context( Context && o ): impl( std::move( o.impl ) )
+    {}
+    
+    Context::Context( const Context & parent, const std::string & key, const std::string & value )
+    {
+        std::shared_ptr< IMPL > impl( std::make_shared< IMPL >() );
+        const char            * k;
+        const char            * v;
+        size_t                  i;
+        bool                    set;
+        
+        set = false;
+        
+        /* A field that is already set keeps its position */
+        for( i = 0; i < parent.GetCount(); i++ )
+        {
+            k = parent.GetKey( i );
+            v = parent.GetValue( i );
+            
+            if( key == k )
+            {
+                impl->Append( key.data(), key.length(), value.data(), value.length() );
+                
+                set = true;
+            }
+            else
+            {
+                impl->Append( k, strlen( k ), v, strlen( v ) );
+            }
+        }
+        
+        if( set == false )
+        {
+            impl->Append( key.data(), key.length(), value.data(), value.length() );
+        }
+        
+        this->impl = impl;
+    }
+    
+    Context::~Context( void )
+    {}
+    
+    Context & Context::operator =( Context o )
+    {
+        swap( *( this ), o );
+        
+        return *( this );
+    }
+    
+    void swap( Context & o1, Context & o2 )
+    {
+        using std::swap;
+        
+        swap( o1.impl, o2.impl );
+    }
+    
+    bool Context::IsEmpty( void ) const
+    {
+        return this->GetCount() == 0;
+    }
+    
+    size_t Context::GetCount( void ) const
+    {
+        return ( this->impl == nullptr ) ? 0 : this->impl->_count;
+    }
+    
+    const char * Context::GetKey( size_t index ) const
+    {
+        return ( index < this->GetCount() ) ? this->impl->_buffer + this->impl->_keys[ index ] : nullptr;
+    }
+    
+    const char * Context::GetValue( size_t index ) const
+    {
+        return ( index < this->GetCount() ) ? this->impl->_buffer + this->impl->_values[ index ] : nullptr;
+    }
+    
+    const char * Context::GetValue( const std::string & key ) const
+    {
+        size_t i;
+        
+        for( i = 0; i < this->GetCount(); i++ )
+        {
+            if( key == this->GetKey( i ) )
+            {
+                return this->GetValue( i );
+            }
+        }
+        
+        return nullptr;
+    }
+    
+    Context::IMPL::IMPL( void ):
+        _count( 0 ),
+        _used( 0 )
+    {}
+    
+    Context::IMPL::~IMPL( void )
+    {}
+    
+    void Context::IMPL::Append( const char * key, size_t keyLength, const char * value, size_t valueLength )
+    {
+        if( this->_count == MaxFields || this->_used + keyLength + valueLength + 2 > BufferSize )
+        {
+            return;
+        }
+        
+        this->_keys[ this->_count ] = static_cast< uint16_t >( this->_used );
+        
+        memcpy( this->_buffer + this->_used, key, keyLength );
+        
+        this->_used                 += keyLength;
+        this->_buffer[ this->_used ] = 0;
+        this->_used                 += 1;
+        
+        this->_values[ this->_count ] = static_cast< uint16_t >( this->_used );
+        
+        memcpy( this->_buffer + this->_used, value, valueLength );
+        
+        this->_used                 += valueLength;
+        this->_buffer[ this->_used ] = 0;
+        this->_used                 += 1;
+        
+        this->_count++;
+    }
+}
@@ -0,0 +1,70 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+/*!
+ * @file        CXX-ContextScope.cpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#include <ULog/ULog.h>
+#include <ULog/CXX/ContextScope.hpp>
+
+namespace ULog
+{
+    class ContextScope::IMPL
+    {
+        public:
+            
+            IMPL( const Context & context );
+            
+            ~IMPL( void );
+            
+            Context         _context;
+            const Context * _previous;
+    };
+    
+    ContextScope::ContextScope( const std::string & key, const std::string & value ): impl( new IMPL( Context( Context::GetCurrent(), key, value ) ) )
+    {
+        this->impl->_previous = Context::SetCurrent( &( this->impl->_context ) );
+    }
+    
+    ContextScope::ContextScope( const Context & context ): impl( new IMPL( context ) )
+    {
+        this->impl->_previous = Context::SetCurrent( &( this->impl->_context ) );
+    }
+    
+    ContextScope::~ContextScope( void )
+    {
+        Context::SetCurrent( this->impl->_previous );
+        
+        delete this->impl;
+    }
+    
+    ContextScope::IMPL::IMPL( const Context & context ):
+        _context( context ),
+        _previous( nullptr )
+    {}
+    
+    ContextScope::IMPL::~IMPL( void )
+    {}
+}
@@ -0,0 +1,586 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+/*!
+ * @file        CXX-Encoder.cpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#include <ULog/ULog.h>
+#include <ULog/CXX/Encoder.hpp>
+#include <ULog/CXX/CallSite.hpp>
+#include <cstdint>
+#include <cstring>
+
+#if defined( __AVX2__ )
+#define ULOG_ENCODER_AVX2   1
+#include <immintrin.h>
+#endif
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define ULOG_ENCODER_SSE2   1
+#include <emmintrin.h>
+#endif
+
+#if defined( __ARM_NEON ) && defined( __aarch64__ )
+#define ULOG_ENCODER_NEON   1
+#include <arm_neon.h>
+#endif
+
+#if defined( _MSC_VER ) && !defined( __clang__ )
+#include <intrin.h>
+#endif
+
+#if defined( _WIN32 ) && defined( GetMessage )
+#undef GetMessage
+#endif
+
+namespace ULog
+{
+    namespace
+    {
+        inline bool NeedsJSONEscape( unsigned char c )
+        {
+            return c < 0x20 || c == '"' || c == '\\';
+        }
+        
+        inline bool NeedsLogfmtEscape( unsigned char c )
+        {
+            return c <= 0x20 || c == '"' || c == '\\' || c == '=';
+        }
+        
+        #if defined( ULOG_ENCODER_AVX2 ) || defined( ULOG_ENCODER_SSE2 )
+        
+        inline size_t CountTrailingZeros( uint32_t x )
+        {
+            #if defined( _MSC_VER ) && !defined( __clang__ )
+            
+            unsigned long i;
+            
+            _BitScanForward( &i, x );
+            
+            return static_cast< size_t >( i );
+            
+            #else
+            
+            return static_cast< size_t >( __builtin_ctz( x ) );
+            
+            #endif
+        }
+        
+        #endif
+        
+        const char * SourceName( Message::Source source )
+        {
+            switch( source )
+            {
+                case Message::SourceCXX:    return "C++";
+                case Message::SourceC:      return "C";
+                case Message::SourceOBJC:   return "Objective-C";
+                case Message::SourceOBJCXX: return "Objective-C++";
+                case Message::SourceASL:    return "ASL";
+                case Message::SourceCS:     return "C#";
+            }
+            
+            return "Unknown";
+        }
+        
+        const char * LevelName( Message::Level level )
+        {
+            switch( level )
+            {
+                case Message::LevelEmergency:   return "Emergency";
+                case Message::LevelAlert:       return "Alert";
+                case Message::LevelCritical:    return "Critical";
+                case Message::LevelError:       return "Error";
+                case Message::LevelWarning:     return "Warning";
+                case Message::LevelNotice:      return "Notice";
+                case Message::LevelInfo:        return "Info";
+                case Message::LevelDebug:       return "Debug";
+            }
+            
+            return "Unknown";
+        }
+        
+        void AppendNumber( std::string & out, uint64_t n )
+        {
+            char   buf[ 20 ];
+            size_t i;
+            
+            i = sizeof( buf );
+            
+            do
+            {
+                buf[ --i ] = static_cast< char >( '0' + ( n % 10 ) );
+                n         /= 10;
+            }
+            while( n != 0 );
+            
+            out.append( buf + i, sizeof( buf ) - i );
+        }
+        
+        /* Keys written by the encoders themselves */
+        bool IsReserved( const char * key, size_t length )
+        {
+            static const char * const reserved[] =
+            {
+                "time", "timestamp", "pid", "tid", "sequence", "source", "level",
+                "message", "category", "file", "line", "function"
+            };
+            
+            for( const char * r: reserved )
+            {
+                if( strlen( r ) == length && memcmp( r, key, length ) == 0 )
+                {
+                    return true;
+                }
+            }
+            
+            return false;
+        }
+        
+        void AppendJSONKey( std::string & out, const char * key, size_t length )
+        {
+            std::string prefixed;
+            
+            if( IsReserved( key, length ) == false )
+            {
+                Encoder::AppendJSONString( out, key, length );
+                
+                return;
+            }
+            
+            /* User keys never shadow the encoder's own, "level" becomes "field.level" */
+            prefixed  = "field.";
+            prefixed += std::string( key, length );
+            
+            Encoder::AppendJSONString( out, prefixed.data(), prefixed.length() );
+        }
+        
+        void AppendLogfmtKey( std::string & out, const char * key, size_t length )
+        {
+            size_t i;
+            
+            if( IsReserved( key, length ) )
+            {
+                out += "field.";
+            }
+            
+            for( i = 0; i < length; i++ )
+            {
+                out += ( NeedsLogfmtEscape( static_cast< unsigned char >( key[ i ] ) ) ) ? '_' : key[ i ];
+            }
+        }
+    }
+    
+    std::string Encoder::EncodeJSON( const Message & msg )
+    {
+        std::string s;
+        
+        EncodeJSON( msg, s );
+        
+        return s;
+    }
+    
+    std::string Encoder::EncodeLogfmt( const Message & msg )
+    {
+        std::string s;
+        
+        EncodeLogfmt( msg, s );
+        
+        return s;
+    }
+    
+    void Encoder::EncodeJSON( const Message & msg, std::string & out )
+    {
+        std::string         time( msg.GetTimeString() );
+        const std::string & message( msg.GetText() );
+        const Context     & context( msg.GetContext() );
+        size_t              i;
+        
+        out += "{\"time\":";
+        AppendJSONString( out, time.data(), time.length() );
+        out += ",\"timestamp\":";
+        AppendNumber( out, ( msg.GetTime() * 1000 ) + msg.GetMilliseconds() );
+        out += ",\"pid\":";
+        AppendNumber( out, msg.GetProcessID() );
+        out += ",\"tid\":";
+        AppendNumber( out, msg.GetThreadID() );
+        out += ",\"sequence\":";
+        AppendNumber( out, msg.GetSequence() );
+        out += ",\"source\":\"";
+        out += SourceName( msg.GetSource() );
+        out += "\",\"level\":\"";
+        out += LevelName( msg.GetLevel() );
+        out += "\",\"message\":";
+        AppendJSONString( out, message.data(), message.length() );
+        
+        if( msg.GetCategory() != nullptr )
+        {
+            out += ",\"category\":";
+            AppendJSONString( out, msg.GetCategory(), strlen( msg.GetCategory() ) );
+        }
+        
+        if( msg.GetCallSite() != nullptr )
+        {
+            const CallSite * site( msg.GetCallSite() );
+            
+            out += ",\"file\":";
+            AppendJSONString( out, site->GetFile(), strlen( site->GetFile() ) );
+            out += ",\"line\":";
+            AppendNumber( out, site->GetLine() );
+            out += ",\"function\":";
+            AppendJSONString( out, site->GetFunction(), strlen( site->GetFunction() ) );
+        }
+        
+        for( i = 0; i < context.GetCount(); i++ )
+        {
+            out += ',';
+            AppendJSONKey( out, context.GetKey( i ), strlen( context.GetKey( i ) ) );
+            out += ':';
+            AppendJSONString( out, context.GetValue( i ), strlen( context.GetValue( i ) ) );
+        }
+        
+        for( const auto & field: msg.GetFields() )
+        {
+            out += ',';
+            AppendJSONKey( out, field.first.data(), field.first.length() );
+            out += ':';
+            AppendJSONString( out, field.second.data(), field.second.length() );
+        }
+        
+        out += '}';
+    }
+    
+    void Encoder::EncodeLogfmt( const Message & msg, std::string & out )
+    {
+        std::string         time( msg.GetTimeString() );
+        const std::string & message( msg.GetText() );
+        const Context     & context( msg.GetContext() );
+        size_t              i;
+        
+        out += "time=";
+        AppendLogfmtValue( out, time.data(), time.length() );
+        out += " timestamp=";
+        AppendNumber( out, ( msg.GetTime() * 1000 ) + msg.GetMilliseconds() );
+        out += " pid=";
+        AppendNumber( out, msg.GetProcessID() );
+        out += " tid=";
+        AppendNumber( out, msg.GetThreadID() );
+        out += " sequence=";
+        AppendNumber( out, msg.GetSequence() );
+        out += " source=";
+        out += SourceName( msg.GetSource() );
+        out += " level=";
+        out += LevelName( msg.GetLevel() );
+        out += " message=";
+        AppendLogfmtValue( out, message.data(), message.length() );
+        
+        if( msg.GetCategory() != nullptr )
+        {
+            out += " category=";
+            AppendLogfmtValue( out, msg.GetCategory(), strlen( msg.GetCategory() ) );
+        }
+        
+        if( msg.GetCallSite() != nullptr )
+        {
+            const CallSite * site( msg.GetCallSite() );
+            
+            out += " file=";
+            AppendLogfmtValue( out, site->GetFile(), strlen( site->GetFile() ) );
+            out += " line=";
+            AppendNumber( out, site->GetLine() );
+            out += " function=";
+            AppendLogfmtValue( out, site->GetFunction(), strlen( site->GetFunction() ) );
+        }
+        
+        for( i = 0; i < context.GetCount(); i++ )
+        {
+            out += ' ';
+            AppendLogfmtKey( out, context.GetKey( i ), strlen( context.GetKey( i ) ) );
+            out += '=';
+            AppendLogfmtValue( out, context.GetValue( i ), strlen( context.GetValue( i ) ) );
+        }
+        
+        for( const auto & field: msg.GetFields() )
+        {
+            out += ' ';
+            AppendLogfmtKey( out, field.first.data(), field.first.length() );
+            out += '=';
+            AppendLogfmtValue( out, field.second.data(), field.second.length() );
+        }
+    }
+    
+    void Encoder::AppendJSONString( std::string & out, const char * s, size_t length )
+    {
+        static const char hex[] = "0123456789abcdef";
+        size_t            n;
+        unsigned char     c;
+        
+        out += '"';
+        
+        while( length > 0 )
+        {
+            n = FindJSONEscape( s, length );
+            
+            out.append( s, n );
+            
+            if( n == length )
+            {
+                break;
+            }
+            
+            c = static_cast< unsigned char >( s[ n ] );
+            
+            switch( c )
+            {
+                case '"':   out += "\\\""; break;
+                case '\\':  out += "\\\\"; break;
+                case '\n':  out += "\\n";  break;
+                case '\r':  out += "\\r";  break;
+                case '\t':  out += "\\t";  break;
+                case '\b':  out += "\\b";  break;
+                case '\f':  out += "\\f";  break;
+                
+                default:
+                    
+                    out += "\\u00";
+                    out += hex[ c >> 4 ];
+                    out += hex[ c & 0x0F ];
+                    break;
+            }
+            
+            s      += n + 1;
+            length -= n + 1;
+        }
+        
+        out += '"';
+    }
+    
+    void Encoder::AppendLogfmtValue( std::string & out, const char * s, size_t length )
+    {
+        if( length > 0 && FindLogfmtEscape( s, length ) == length )
+        {
+            out.append( s, length );
+        }
+        else
+        {
+            AppendJSONString( out, s, length );
+        }
+    }
+    
+    size_t Encoder::FindJSONEscape( const char * s, size_t length )
+    {
+        size_t i;
+        
+        i = 0;
+        
+        #if defined( ULOG_ENCODER_AVX2 )
+        
+        {
+            const __m256i quote     = _mm256_set1_epi8( '"' );
+            const __m256i backslash = _mm256_set1_epi8( '\\' );
+            const __m256i control   = _mm256_set1_epi8( 0x1F );
+            
+            for( ; i + 32 <= length; i += 32 )
+            {
+                __m256i  v;
+                __m256i  m;
+                uint32_t bits;
+                
+                v    = _mm256_loadu_si256( reinterpret_cast< const __m256i * >( s + i ) );
+                m    = _mm256_or_si256( _mm256_cmpeq_epi8( v, quote ), _mm256_cmpeq_epi8( v, backslash ) );
+                m    = _mm256_or_si256( m, _mm256_cmpeq_epi8( _mm256_min_epu8( v, control ), v ) );
+                bits = static_cast< uint32_t >( _mm256_movemask_epi8( m ) );
+                
+                if( bits != 0 )
+                {
+                    return i + CountTrailingZeros( bits );
+                }
+            }
+        }
+        
+        #endif
+        
+        #if defined( ULOG_ENCODER_SSE2 )
+        
+        {
+            const __m128i quote     = _mm_set1_epi8( '"' );
+            const __m128i backslash = _mm_set1_epi8( '\\' );
+            const __m128i control   = _mm_set1_epi8( 0x1F );
+            
+            for( ; i + 16 <= length; i += 16 )
+            {
+                __m128i  v;
+                __m128i  m;
+                uint32_t bits;
+                
+                v    = _mm_loadu_si128( reinterpret_cast< const __m128i * >( s + i ) );
+                m    = _mm_or_si128( _mm_cmpeq_epi8( v, quote ), _mm_cmpeq_epi8( v, backslash ) );
+                m    = _mm_or_si128( m, _mm_cmpeq_epi8( _mm_min_epu8( v, control ), v ) );
+                bits = static_cast< uint32_t >( _mm_movemask_epi8( m ) );
+                
+                if( bits != 0 )
+                {
+                    return i + CountTrailingZeros( bits );
+                }
+            }
+        }
+        
+        #elif defined( ULOG_ENCODER_NEON )
+        
+        {
+            const uint8x16_t quote     = vdupq_n_u8( '"' );
+            const uint8x16_t backslash = vdupq_n_u8( '\\' );
+            const uint8x16_t control   = vdupq_n_u8( 0x1F );
+            
+            for( ; i + 16 <= length; i += 16 )
+            {
+                uint8x16_t v;
+                uint8x16_t m;
+                
+                v = vld1q_u8( reinterpret_cast< const uint8_t * >( s + i ) );
+                m = vorrq_u8( vceqq_u8( v, quote ), vceqq_u8( v, backslash ) );
+                m = vorrq_u8( m, vcleq_u8( v, control ) );
+                
+                if( vmaxvq_u8( m ) != 0 )
+                {
+                    break;
+                }
+            }
+        }
+        
+        #endif
+        
+        for( ; i < length; i++ )
+        {
+            if( NeedsJSONEscape( static_cast< unsigned char >( s[ i ] ) ) )
+            {
+                return i;
+            }
+        }
+        
+        return length;
+    }
+    
+    size_t Encoder::FindLogfmtEscape( const char * s, size_t length )
+    {
+        size_t i;
+        
+        i = 0;
+        
+        #if defined( ULOG_ENCODER_AVX2 )
+        
+        {
+            const __m256i quote     = _mm256_set1_epi8( '"' );
+            const __m256i backslash = _mm256_set1_epi8( '\\' );
+            const __m256i equal     = _mm256_set1_epi8( '=' );
+            const __m256i space     = _mm256_set1_epi8( 0x20 );
+            
+            for( ; i + 32 <= length; i += 32 )
+            {
+                __m256i  v;
+                __m256i  m;
+                uint32_t bits;
+                
+                v    = _mm256_loadu_si256( reinterpret_cast< const __m256i * >( s + i ) );
+                m    = _mm256_or_si256( _mm256_cmpeq_epi8( v, quote ), _mm256_cmpeq_epi8( v, backslash ) );
+                m    = _mm256_or_si256( m, _mm256_cmpeq_epi8( v, equal ) );
+                m    = _mm256_or_si256( m, _mm256_cmpeq_epi8( _mm256_min_epu8( v, space ), v ) );
+                bits = static_cast< uint32_t >( _mm256_movemask_epi8( m ) );
+                
+                if( bits != 0 )
+                {
+                    return i + CountTrailingZeros( bits );
+                }
+            }
+        }
+        
+        #endif
+        
+        #if defined( ULOG_ENCODER_SSE2 )
+        
+        {
+            const __m128i quote     = _mm_set1_epi8( '"' );
+            const __m128i backslash = _mm_set1_epi8( '\\' );
+            const __m128i equal     = _mm_set1_epi8( '=' );
+            const __m128i space     = _mm_set1_epi8( 0x20 );
+            
+            for( ; i + 16 <= length; i += 16 )
+            {
+                __m128i  v;
+                __m128i  m;
+                uint32_t bits;
+                
+                v    = _mm_loadu_si128( reinterpret_cast< const __m128i * >( s + i ) );
+                m    = _mm_or_si128( _mm_cmpeq_epi8( v, quote ), _mm_cmpeq_epi8( v, backslash ) );
+                m    = _mm_or_si128( m, _mm_cmpeq_epi8( v, equal ) );
+                m    = _mm_or_si128( m, _mm_cmpeq_epi8( _mm_min_epu8( v, space ), v ) );
+                bits = static_cast< uint32_t >( _mm_movemask_epi8( m ) );
+                
+                if( bits != 0 )
+                {
+                    return i + CountTrailingZeros( bits );
+                }
+            }
+        }
+        
+        #elif defined( ULOG_ENCODER_NEON )
+        
+        {
+            const uint8x16_t quote     = vdupq_n_u8( '"' );
+            const uint8x16_t backslash = vdupq_n_u8( '\\' );
+            const uint8x16_t equal     = vdupq_n_u8( '=' );
+            const uint8x16_t space     = vdupq_n_u8( 0x20 );
+            
+            for( ; i + 16 <= length; i += 16 )
+            {
+                uint8x16_t v;
+                uint8x16_t m;
+                
+                v = vld1q_u8( reinterpret_cast< const uint8_t * >( s + i ) );
+                m = vorrq_u8( vceqq_u8( v, quote ), vceqq_u8( v, backslash ) );
+                m = vorrq_u8( m, vceqq_u8( v, equal ) );
+                m = vorrq_u8( m, vcleq_u8( v, space ) );
+                
+                if( vmaxvq_u8( m ) != 0 )
+                {
+                    break;
+                }
+            }
+        }
+        
+        #endif
+        
+        for( ; i < length; i++ )
+        {
+            if( NeedsLogfmtEscape( static_cast< unsigned char >( s[ i ] ) ) )
+            {
+                return i;
+            }
+        }
+        
+        return length;
+    }
+}
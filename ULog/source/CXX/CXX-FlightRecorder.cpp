@@ -0,0 +1,260 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+/*!
+ * @file        CXX-FlightRecorder.cpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#include <ULog/ULog.h>
+#include <ULog/CXX/FlightRecorder.hpp>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <algorithm>
+
+namespace ULog
+{
+    namespace
+    {
+        const size_t CacheLineSize = 64;
+        
+        /* Built by the writer, so slots hold nothing until a message lands */
+        class Entry
+        {
+            public:
+                
+                Entry( uint64_t t, Message m ): ticket( t ), message( std::move( m ) )
+                {}
+                
+                uint64_t ticket;
+                Message  message;
+        };
+        
+        typedef struct
+        {
+            std::atomic< Entry * > entry;
+            char                   padding[ CacheLineSize - sizeof( std::atomic< Entry * > ) ];
+        }
+        Slot;
+        
+        /*
+         * Whatever comes out of the exchange belongs to the caller, so it can
+         * be read and freed without a lock. A writer that was lapped puts back
+         * the newer entry it displaced, and only the newest one is kept.
+         */
+        void Store( Slot & slot, Entry * entry )
+        {
+            while( entry != nullptr )
+            {
+                Entry  * previous;
+                uint64_t ticket;
+                
+                /* Once stored, the entry may already be someone else's */
+                ticket   = entry->ticket;
+                previous = slot.entry.exchange( entry, std::memory_order_acq_rel );
+                
+                if( previous != nullptr && previous->ticket > ticket )
+                {
+                    entry = previous;
+                }
+                else
+                {
+                    delete previous;
+                    
+                    entry = nullptr;
+                }
+            }
+        }
+    }
+    
+    class FlightRecorder::IMPL
+    {
+        public:
+            
+            IMPL( size_t capacity );
+            IMPL( const IMPL & o );
+            
+            ~IMPL( void );
+            
+            std::unique_ptr< Slot[] > _slots;
+            size_t                    _capacity;
+            std::atomic< uint64_t >   _head;
+            std::atomic< uint64_t >   _floor;
+            mutable std::mutex        _mtx;
+    };
+    
+    FlightRecorder::FlightRecorder( size_t capacity ): impl( new IMPL( capacity ) )
+    {}
+    
+    FlightRecorder::FlightRecorder( const FlightRecorder & o ): impl( new IMPL( *( o.impl ) ) )
+    {}
+    
+    FlightRecorder::FlightRecorder( FlightRecorder && o ): impl( o.impl )
+    {
+        o.impl = nullptr;
+    }
+    
+    FlightRecorder::~FlightRecorder( void )
+    {
+        delete this->impl;
+    }
+    
+    FlightRecorder & FlightRecorder::operator =( FlightRecorder o )
+    {
+        swap( *( this ), o );
+        
+        return *( this );
+    }
+    
+    void swap( FlightRecorder & o1, FlightRecorder & o2 )
+    {
+        using std::swap;
+        
+        swap( o1.impl, o2.impl );
+    }
+    
+    size_t FlightRecorder::GetCapacity( void ) const
+    {
+        return this->impl->_capacity;
+    }
+    
+    void FlightRecorder::Add( Message msg )
+    {
+        uint64_t ticket;
+        
+        ticket = this->impl->_head.fetch_add( 1, std::memory_order_relaxed );
+        
+        /* Already behind a drain: it would come out after newer messages */
+        if( ticket < this->impl->_floor.load( std::memory_order_relaxed ) )
+        {
+            return;
+        }
+        
+        Store( this->impl->_slots[ ticket % this->impl->_capacity ], new Entry( ticket, std::move( msg ) ) );
+    }
+    
+    void FlightRecorder::Clear( void )
+    {
+        this->Drain();
+    }
+    
+    std::vector< Message > FlightRecorder::Drain( void )
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        std::vector< Entry * >        entries;
+        std::vector< Message >        messages;
+        uint64_t                      floor;
+        uint64_t                      head;
+        
+        floor = this->impl->_floor.load( std::memory_order_relaxed );
+        head  = this->impl->_head.load( std::memory_order_acquire );
+        
+        for( size_t i = 0; i < this->impl->_capacity; i++ )
+        {
+            Entry * entry;
+            
+            entry = this->impl->_slots[ i ].entry.exchange( nullptr, std::memory_order_acq_rel );
+            
+            /* Stale writers that landed after the previous drain */
+            if( entry != nullptr && entry->ticket < floor )
+            {
+                delete entry;
+            }
+            else if( entry != nullptr )
+            {
+                entries.push_back( entry );
+            }
+        }
+        
+        std::sort
+        (
+            entries.begin(),
+            entries.end(),
+            []( const Entry * e1, const Entry * e2 ) -> bool
+            {
+                return e1->ticket < e2->ticket;
+            }
+        );
+        
+        /* Anything older than what is returned now is rejected later on */
+        floor = ( entries.size() > 0 ) ? std::max( head, entries.back()->ticket + 1 ) : head;
+        
+        this->impl->_floor.store( floor, std::memory_order_relaxed );
+        
+        messages.reserve( entries.size() );
+        
+        for( auto entry: entries )
+        {
+            messages.push_back( std::move( entry->message ) );
+            
+            delete entry;
+        }
+        
+        return messages;
+    }
+    
+    FlightRecorder::IMPL::IMPL( size_t capacity ):
+        _slots( new Slot[ std::max< size_t >( capacity, 1 ) ] ),
+        _capacity( std::max< size_t >( capacity, 1 ) ),
+        _head( 0 ),
+        _floor( 0 )
+    {
+        for( size_t i = 0; i < this->_capacity; i++ )
+        {
+            this->_slots[ i ].entry = nullptr;
+        }
+    }
+    
+    /* Entries are taken out to be copied, then stored back */
+    FlightRecorder::IMPL::IMPL( const IMPL & o ):
+        _slots( new Slot[ o._capacity ] ),
+        _capacity( o._capacity ),
+        _head( 0 ),
+        _floor( 0 )
+    {
+        std::lock_guard< std::mutex > l( o._mtx );
+        
+        this->_head  = o._head.load();
+        this->_floor = o._floor.load();
+        
+        for( size_t i = 0; i < this->_capacity; i++ )
+        {
+            Entry * entry;
+            
+            entry = o._slots[ i ].entry.exchange( nullptr, std::memory_order_acq_rel );
+            
+            this->_slots[ i ].entry = ( entry == nullptr ) ? nullptr : new Entry( entry->ticket, entry->message );
+            
+            Store( o._slots[ i ], entry );
+        }
+    }
+    
+    FlightRecorder::IMPL::~IMPL( void )
+    {
+        for( size_t i = 0; i < this->_capacity; i++ )
+        {
+            delete this->_slots[ i ].entry.load();
+        }
+    }
+}
@@ -29,26 +29,121 @@
 
 #include <ULog/ULog.h>
 #include <ULog/CXX/SpinLock.hpp>
+#include <ULog/CXX/Encoder.hpp>
+#include <ULog/CXX/SearchIndex.hpp>
+#include <ULog/CXX/Scanner.hpp>
+#include <ULog/CXX/Metrics.hpp>
+#include <ULog/CXX/FlightRecorder.hpp>
+#include "CXX-Probes.hpp"
 #include <cstdlib>
+#include <csignal>
 #include <mutex>
 #include <iostream>
 #include <fstream>
 #include <map>
+#include <deque>
 #include <memory>
 #include <algorithm>
+#include <atomic>
+#include <thread>
+#include <system_error>
+#include <chrono>
+#include <condition_variable>
+#include <iterator>
 
 #if defined( _WIN32 )
 #include <Windows.h>
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined( _WIN32 )
 #elif defined( __APPLE__ )
 #include <ULog/CXX/ASL.hpp>
 #include <dispatch/dispatch.h>
 #endif
 
+#if defined( _WIN32 ) && defined( GetMessage )
+#undef GetMessage
+#endif
+
 static ULog::Logger * volatile SharedLogger   = nullptr;
 static ULog::SpinLock          ULogGlobalLock = 0;
 
 namespace ULog
 {
+    namespace
+    {
+        const size_t MinimumScanChunk = 16384;
+        const size_t BatchSlice       = 64;
+        const size_t LevelCount       = Message::LevelDebug + 1;
+        const size_t SourceCount      = Message::SourceCS   + 1;
+        
+        std::atomic< unsigned int > FlightRecorderSignals( 0 );
+        
+        void FlightRecorderSignalHandler( int signal )
+        {
+            FlightRecorderSignals.fetch_add( 1, std::memory_order_relaxed );
+            
+            /* Some platforms reset the disposition before calling the handler */
+            std::signal( signal, FlightRecorderSignalHandler );
+        }
+        
+        typedef struct
+        {
+            uint64_t                              sampling;
+            double                                rate;
+            double                                burst;
+            double                                tokens;
+            std::chrono::steady_clock::time_point refill;
+        }
+        Limit;
+        
+        void Refill( Limit & limit, std::chrono::steady_clock::time_point now )
+        {
+            if( limit.rate <= 0 )
+            {
+                return;
+            }
+            
+            limit.tokens = std::min( limit.burst, limit.tokens + ( limit.rate * std::chrono::duration< double >( now - limit.refill ).count() ) );
+            limit.refill = now;
+        }
+        
+        inline uint64_t GetTimestamp( const Message & msg )
+        {
+            return ( msg.GetTime() * 1000 ) + msg.GetMilliseconds();
+        }
+        
+        inline bool Matches( const Message & msg, const std::string & query, bool caseInsensitive )
+        {
+            const std::string & text( msg.GetText() );
+            
+            return Scanner::Find( text.data(), text.length(), query.data(), query.length(), caseInsensitive ) != Scanner::NotFound;
+        }
+        
+        /* Only contended acquisitions are timed, the fast path is a try_lock */
+        template< typename T >
+        std::unique_lock< T > Acquire( T & mutex, Metrics & metrics )
+        {
+            std::unique_lock< T > l( mutex, std::try_to_lock );
+            
+            if( l.owns_lock() == false )
+            {
+                auto start = std::chrono::steady_clock::now();
+                
+                l.lock();
+                
+                metrics.AddLockWait( static_cast< uint64_t >( std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - start ).count() ) );
+            }
+            
+            return l;
+        }
+    }
+    
     class Logger::IMPL
     {
         public:
@@ -58,12 +153,74 @@ namespace ULog
             
             ~IMPL( void );
             
-                    std::vector< Message >                                   _messages;
+                    std::deque< Message >                                    _messages;
             mutable std::recursive_mutex                                     _rmtx;
                     uint64_t                                                 _displayOptions;
-                    bool                                                     _enabled;
+                    Format                                                   _format;
+                    std::atomic< bool >                                      _enabled;
+                    std::atomic< bool >                                      _limited;
+                    std::atomic< uint64_t >                                  _sequence;
+                    size_t                                                   _tail;
+                    size_t                                                   _historyLimit;
+                    size_t                                                   _scanThreads;
+                    SearchIndex                                              _index;
+                    bool                                                     _indexed;
+                    Statistics                                               _statistics;
+                    Metrics                                                  _metrics;
+                    uint64_t                                                 _deduplicationWindow;
+                    bool                                                     _hasLast;
+                    Message::Source                                          _lastSource;
+                    Message::Level                                           _lastLevel;
+                    std::string                                              _lastText;
+                    uint64_t                                                 _repeats;
+                    uint64_t                                                 _runStart;
+                    Limit                                                    _levelLimits[ LevelCount ];
+                    Limit                                                    _sourceLimits[ SourceCount ];
+                    uint64_t                                                 _random;
+            mutable std::mutex                                               _qmtx;
+                    std::condition_variable                                  _notEmpty;
+                    std::condition_variable                                  _notFull;
+                    std::condition_variable                                  _idle;
+                    std::deque< Message >                                    _pending;
+                    std::atomic< size_t >                                    _capacity;
+                    Backpressure                                             _backpressure;
+                    uint64_t                                                 _backpressureTimeout;
+                    Message::Level                                           _backpressureLevel;
+                    uint64_t                                                 _dropped;
+                    std::chrono::steady_clock::time_point                    _dropMarker;
+                    bool                                                     _busy;
+                    bool                                                     _stop;
+                    std::thread                                              _worker;
+                    std::atomic< Message::Level >                            _priorityLevel;
+                    std::atomic< bool >                                      _prioritySync;
+                    std::atomic< FlightRecorder * >                          _recorder;
+                    std::vector< std::unique_ptr< FlightRecorder > >         _recorders;
+                    std::atomic< Message::Level >                            _recorderLevel;
+                    std::atomic< Message::Level >                            _recorderTrigger;
+                    std::atomic< unsigned int >                              _signals;
                     std::map< std::string, std::shared_ptr< std::fstream > > _files;
                     
+                    bool Admit( Message::Source source, Message::Level level );
+                    void UpdateLimited( void );
+                    bool Sample( const Limit & limit );
+                    void Process( Message & m );
+                    void Write( Message & m, bool stamped );
+                    void WriteTo( Metrics::Sink sink, std::ostream & os, const std::string & s );
+                    bool Enqueue( Message & m );
+                    void Drop( Statistics::Drop reason, Message::Level level );
+                    void WriteDropMarker( uint64_t n );
+                    void Start( void );
+                    void Stop( void );
+                    void Run( void );
+                    void Drain( void );
+                    void Sync( void );
+                    void Dump( void );
+                    bool Deduplicate( const Message & m );
+                    void FlushRepeats( void );
+                    void Trim( void );
+                    void BuildIndex( void );
+                    void GetRange( uint64_t from, uint64_t to, std::deque< Message >::const_iterator & begin, std::deque< Message >::const_iterator & end ) const;
+                    
             #ifdef __APPLE__
             
             dispatch_queue_t _queue;
@@ -123,6 +280,12 @@ namespace ULog
     
     Logger::~Logger( void )
     {
+        /* Writes a pending "last message repeated" summary before stopping */
+        if( this->impl != nullptr )
+        {
+            this->Flush();
+        }
+        
         delete this->impl;
     }
     
@@ -164,6 +327,20 @@ namespace ULog
         this->impl->_displayOptions = opt;
     }
     
+    Logger::Format Logger::GetFormat( void )
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        return this->impl->_format;
+    }
+    
+    void Logger::SetFormat( Format format )
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        this->impl->_format = format;
+    }
+    
     bool Logger::IsEnabled( void ) const
     {
         std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
@@ -189,570 +366,2075 @@ namespace ULog
         #endif
     }
     
-    void Logger::Clear( void )
+    size_t Logger::GetHistoryLimit( void ) const
     {
         std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
         
-        this->impl->_messages.clear();
+        return this->impl->_historyLimit;
     }
     
-    void Logger::AddLogFile( const std::string & path )
+    void Logger::SetHistoryLimit( size_t limit )
     {
         std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
-        std::shared_ptr< std::fstream >         s;
-        
-        if( path.length() == 0 )
-        {
-            return;
-        }
         
-        if( this->impl->_files.find( path ) != this->impl->_files.end() )
-        {
-            return;
-        }
+        this->impl->_historyLimit = limit;
         
-        s = std::make_shared< std::fstream >
-        (
-              path,
-              std::ios_base::app
-            | std::ios_base::out
-        );
+        this->impl->Trim();
+    }
+    
+    size_t Logger::GetScanThreads( void ) const
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
         
-        if( s->good() == false )
-        {
-            this->Error( "ULog - Error opening log file: %s", path.c_str() );
-            
-            return;
-        }
+        return this->impl->_scanThreads;
+    }
+    
+    void Logger::SetScanThreads( size_t threads )
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
         
-        this->impl->_files[ path ] = s;
+        this->impl->_scanThreads = threads;
     }
     
-    #ifdef __APPLE__
+    uint64_t Logger::GetDeduplicationWindow( void ) const
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        return this->impl->_deduplicationWindow;
+    }
     
-    void Logger::AddASLSender( const std::string & sender )
+    void Logger::SetDeduplicationWindow( uint64_t milliseconds )
     {
         std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
         
-        if( sender.length() == 0 )
+        if( milliseconds == 0 )
         {
-            return;
+            this->impl->FlushRepeats();
+            
+            this->impl->_hasLast = false;
         }
         
-        this->impl->_asl.AddSender( sender );
-        this->impl->_asl.Start();
+        this->impl->_deduplicationWindow = milliseconds;
     }
     
-    #endif
-    
-    void Logger::Log( const Message & msg_ )
+    uint64_t Logger::GetSampling( Message::Level level ) const
     {
-        #ifndef __APPLE__
-        
-        const Message                         & msg( msg_ );
-        std::string                             s;
         std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
         
-        #endif
-        
-        #ifdef __APPLE__
-        
-        Message msg;
-        
-        msg = msg_;
+        return ( static_cast< size_t >( level ) < LevelCount ) ? this->impl->_levelLimits[ level ].sampling : 0;
+    }
+    
+    uint64_t Logger::GetSampling( Message::Source source ) const
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
         
-        dispatch_async
-        (
-            this->impl->_queue,
-            ^( void )
-            {
-                std::string                             s;
-                std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
-                
-        #endif
+        return ( static_cast< size_t >( source ) < SourceCount ) ? this->impl->_sourceLimits[ source ].sampling : 0;
+    }
+    
+    void Logger::SetSampling( Message::Level level, uint64_t n )
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
         
-        if( this->impl->_enabled == false )
+        if( static_cast< size_t >( level ) < LevelCount )
         {
-            return;
+            this->impl->_levelLimits[ level ].sampling = n;
+            
+            this->impl->UpdateLimited();
         }
+    }
+    
+    void Logger::SetSampling( Message::Source source, uint64_t n )
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
         
-        if( this->impl->_displayOptions & DisplayOptionProcess )
+        if( static_cast< size_t >( source ) < SourceCount )
         {
-            s += "[ " + msg.GetProcessString() + " ]> ";
+            this->impl->_sourceLimits[ source ].sampling = n;
+            
+            this->impl->UpdateLimited();
         }
+    }
+    
+    double Logger::GetRateLimit( Message::Level level ) const
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        return ( static_cast< size_t >( level ) < LevelCount ) ? this->impl->_levelLimits[ level ].rate : 0;
+    }
+    
+    double Logger::GetRateLimit( Message::Source source ) const
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
         
-        if( this->impl->_displayOptions & DisplayOptionTime )
+        return ( static_cast< size_t >( source ) < SourceCount ) ? this->impl->_sourceLimits[ source ].rate : 0;
+    }
+    
+    void Logger::SetRateLimit( Message::Level level, double rate, double burst )
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        if( static_cast< size_t >( level ) < LevelCount )
         {
-            s += "[ " + msg.GetTimeString() + " ]> ";
+            Limit & limit = this->impl->_levelLimits[ level ];
+            
+            limit.rate   = rate;
+            limit.burst  = std::max( burst, 1.0 );
+            limit.tokens = limit.burst;
+            limit.refill = std::chrono::steady_clock::now();
+            
+            this->impl->UpdateLimited();
         }
+    }
+    
+    void Logger::SetRateLimit( Message::Source source, double rate, double burst )
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
         
-        if( this->impl->_displayOptions & DisplayOptionSource )
+        if( static_cast< size_t >( source ) < SourceCount )
         {
-            s += "[ " + msg.GetSourceString() + " ]> ";
+            Limit & limit = this->impl->_sourceLimits[ source ];
+            
+            limit.rate   = rate;
+            limit.burst  = std::max( burst, 1.0 );
+            limit.tokens = limit.burst;
+            limit.refill = std::chrono::steady_clock::now();
+            
+            this->impl->UpdateLimited();
         }
+    }
+    
+    size_t Logger::GetQueueCapacity( void ) const
+    {
+        std::lock_guard< std::mutex > l( this->impl->_qmtx );
         
-        if( this->impl->_displayOptions & DisplayOptionLevel )
+        return this->impl->_capacity;
+    }
+    
+    void Logger::SetQueueCapacity( size_t capacity )
+    {
+        if( capacity == 0 )
         {
-            s += "[ " + msg.GetLevelString() + " ]> ";
+            this->impl->Stop();
+            
+            return;
         }
         
-        #if defined( _WIN32 ) && defined( GetMessage )
-        #undef GetMessage
-        #endif
-
-        s += msg.GetMessage();
-        
-        if( msg.GetSource() != Message::SourceASL )
         {
-            #ifdef _WIN32
-            
-            OutputDebugStringA( s.c_str() );
-            OutputDebugStringA( "\n" );
-            
-            /* Detects if we run in console... */
-            {
-                SHFILEINFOA fi;
-                char        proc[ MAX_PATH ];
-                DWORD_PTR   hr;
-
-                memset( proc, 0, MAX_PATH );
-                GetModuleFileNameA( NULL, proc, MAX_PATH );
-
-                if( strlen( proc ) == 0 )
-                {
-                    return;
-                }
-
-                hr = SHGetFileInfoA( proc, 0, &fi, 0, SHGFI_EXETYPE );
-
-                if( ( hr & 0xFFFF ) == IMAGE_NT_SIGNATURE && ( ( hr >> 16 ) & 0xFFFF ) == 0 )
-                {
-                    std::cerr << s << std::endl;
-                }
-            }
-
-            #else
+            std::lock_guard< std::mutex > l( this->impl->_qmtx );
             
-            std::cerr << s << std::endl;
+            this->impl->_capacity = capacity;
             
-            #endif
+            this->impl->Start();
         }
         
-        for( const auto & k: this->impl->_files )
+        this->impl->_notFull.notify_all();
+    }
+    
+    Logger::Backpressure Logger::GetBackpressure( void ) const
+    {
+        std::lock_guard< std::mutex > l( this->impl->_qmtx );
+        
+        return this->impl->_backpressure;
+    }
+    
+    void Logger::SetBackpressure( Backpressure policy )
+    {
         {
-            *( k.second ) << s << std::endl;
+            std::lock_guard< std::mutex > l( this->impl->_qmtx );
+            
+            this->impl->_backpressure = policy;
         }
         
-        this->impl->_messages.push_back( msg );
-        std::sort( this->impl->_messages.begin(), this->impl->_messages.end() );
-        
-        #ifdef __APPLE__
-        
-            }
-        );
-        
-        #endif
+        this->impl->_notFull.notify_all();
     }
     
-    void Logger::Log( const char * fmt, ... )
+    uint64_t Logger::GetBackpressureTimeout( void ) const
     {
-        va_list                                 ap;
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
-        
-        va_start( ap, fmt );
-        
-        this->Log( fmt, ap );
+        std::lock_guard< std::mutex > l( this->impl->_qmtx );
         
-        va_end( ap );
+        return this->impl->_backpressureTimeout;
     }
     
-    void Logger::Log( const char * fmt, va_list ap )
+    void Logger::SetBackpressureTimeout( uint64_t milliseconds )
     {
-        this->Log( Message::LevelDebug, fmt, ap );
+        std::lock_guard< std::mutex > l( this->impl->_qmtx );
+        
+        this->impl->_backpressureTimeout = milliseconds;
     }
     
-    void Logger::Log( Message::Level level, const char * fmt, ... )
+    Message::Level Logger::GetBackpressureLevel( void ) const
     {
-        va_list                                 ap;
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
-        
-        va_start( ap, fmt );
-        
-        this->Log( level, fmt, ap );
+        std::lock_guard< std::mutex > l( this->impl->_qmtx );
         
-        va_end( ap );
+        return this->impl->_backpressureLevel;
     }
     
-    void Logger::Log( Message::Level level, const char * fmt, va_list ap )
+    void Logger::SetBackpressureLevel( Message::Level level )
     {
-        this->Log( Message::SourceCXX, level, fmt, ap );
+        std::lock_guard< std::mutex > l( this->impl->_qmtx );
+        
+        this->impl->_backpressureLevel = level;
     }
     
-    void Logger::Log( Message::Source source, Message::Level level, const char * fmt, ... )
+    Message::Level Logger::GetPriorityLevel( void ) const
     {
-        va_list                                 ap;
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
-        
-        va_start( ap, fmt );
-        
-        this->Log( source, level, fmt, ap );
-        
-        va_end( ap );
+        return this->impl->_priorityLevel;
     }
     
-    void Logger::Log( Message::Source source, Message::Level level, const char * fmt, va_list ap )
+    void Logger::SetPriorityLevel( Message::Level level )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
-        Message                                 msg( source, level, fmt, ap );
-        
-        this->Log( msg );
+        this->impl->_priorityLevel = level;
     }
     
-    void Logger::Emergency( const char * fmt, ... )
+    bool Logger::IsPrioritySyncEnabled( void ) const
     {
-        va_list                                 ap;
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
-        
-        va_start( ap, fmt );
-        
-        this->Emergency( fmt, ap );
-        
-        va_end( ap );
+        return this->impl->_prioritySync;
     }
     
-    void Logger::Emergency( const char * fmt, va_list ap )
+    void Logger::SetPrioritySyncEnabled( bool value )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
-        
-        this->Emergency( Message::SourceCXX, fmt, ap );
+        this->impl->_prioritySync = value;
     }
     
-    void Logger::Emergency( Message::Source source, const char * fmt, ... )
+    size_t Logger::GetFlightRecorderCapacity( void ) const
     {
-        va_list                                 ap;
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        FlightRecorder * recorder;
         
-        va_start( ap, fmt );
-        
-        this->Emergency( source, fmt, ap );
+        recorder = this->impl->_recorder;
         
-        va_end( ap );
+        return ( recorder == nullptr ) ? 0 : recorder->GetCapacity();
     }
     
-    void Logger::Emergency( Message::Source source, const char * fmt, va_list ap )
+    Message::Level Logger::GetFlightRecorderLevel( void ) const
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
-        
-        this->Log( source, Message::LevelEmergency, fmt, ap );
+        return this->impl->_recorderLevel;
     }
     
-    void Logger::Alert( const char * fmt, ... )
+    void Logger::SetFlightRecorder( size_t capacity, Message::Level level )
     {
-        va_list                                 ap;
         std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        FlightRecorder                        * previous;
+        FlightRecorder                        * recorder;
         
-        va_start( ap, fmt );
+        previous = this->impl->_recorder;
+        recorder = nullptr;
         
-        this->Alert( fmt, ap );
+        this->impl->_recorderLevel = level;
         
-        va_end( ap );
+        if( previous != nullptr && previous->GetCapacity() == capacity )
+        {
+            return;
+        }
+        
+        /*
+         * Replaced rings are kept (empty) for the logger's lifetime, as a
+         * concurrent caller may still be adding to one.
+         */
+        if( capacity > 0 )
+        {
+            this->impl->_recorders.emplace_back( new FlightRecorder( capacity ) );
+            
+            recorder = this->impl->_recorders.back().get();
+        }
+        
+        this->impl->_recorder = recorder;
+        
+        if( previous == nullptr )
+        {
+            return;
+        }
+        
+        for( auto & m: previous->Drain() )
+        {
+            if( recorder != nullptr )
+            {
+                recorder->Add( std::move( m ) );
+            }
+        }
     }
     
-    void Logger::Alert( const char * fmt, va_list ap )
+    Message::Level Logger::GetFlightRecorderTrigger( void ) const
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
-        
-        this->Alert( Message::SourceCXX, fmt, ap );
+        return this->impl->_recorderTrigger;
     }
     
-    void Logger::Alert( Message::Source source, const char * fmt, ... )
+    void Logger::SetFlightRecorderTrigger( Message::Level level )
     {
-        va_list                                 ap;
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
-        
-        va_start( ap, fmt );
-        
-        this->Alert( source, fmt, ap );
-        
-        va_end( ap );
+        this->impl->_recorderTrigger = level;
     }
     
-    void Logger::Alert( Message::Source source, const char * fmt, va_list ap )
+    void Logger::DumpFlightRecorder( void )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::unique_lock< std::recursive_mutex > l( Acquire( this->impl->_rmtx, this->impl->_metrics ) );
         
-        this->Log( source, Message::LevelAlert, fmt, ap );
+        this->impl->Dump();
     }
     
-    void Logger::Critical( const char * fmt, ... )
+    void Logger::SetFlightRecorderSignal( int signal )
     {
-        va_list                                 ap;
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::signal( signal, FlightRecorderSignalHandler );
+    }
+    
+    void Logger::Flush( void )
+    {
+        this->impl->Drain();
         
-        va_start( ap, fmt );
+        #ifdef __APPLE__
         
-        this->Critical( fmt, ap );
+        /*
+         * Synchronous, so the blocks queued before it and the summary are
+         * written when Flush returns. Must not be called from the queue.
+         */
+        dispatch_sync
+        (
+            this->impl->_queue,
+            ^( void )
+            {
+                std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+                
+                this->impl->FlushRepeats();
+            }
+        );
         
-        va_end( ap );
+        #else
+        
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        this->impl->FlushRepeats();
+        
+        #endif
     }
     
-    void Logger::Critical( const char * fmt, va_list ap )
+    void Logger::Clear( void )
     {
         std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
         
-        this->Critical( Message::SourceCXX, fmt, ap );
+        this->impl->_messages.clear();
+        this->impl->_index.Clear();
+        
+        this->impl->_tail = 0;
     }
     
-    void Logger::Critical( Message::Source source, const char * fmt, ... )
+    void Logger::AddLogFile( const std::string & path )
     {
-        va_list                                 ap;
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::unique_lock< std::recursive_mutex > l( this->impl->_rmtx );
+        std::shared_ptr< std::fstream >          s;
         
-        va_start( ap, fmt );
+        if( path.length() == 0 )
+        {
+            return;
+        }
         
-        this->Critical( source, fmt, ap );
+        if( this->impl->_files.find( path ) != this->impl->_files.end() )
+        {
+            return;
+        }
         
-        va_end( ap );
+        s = std::make_shared< std::fstream >
+        (
+              path,
+              std::ios_base::app
+            | std::ios_base::out
+        );
+        
+        if( s->good() == false )
+        {
+            /* Logging may wait for the worker, which needs the lock */
+            l.unlock();
+            
+            this->Error( "ULog - Error opening log file: %s", path.c_str() );
+            
+            return;
+        }
+        
+        this->impl->_files[ path ] = s;
     }
     
-    void Logger::Critical( Message::Source source, const char * fmt, va_list ap )
+    #ifdef __APPLE__
+    
+    void Logger::AddASLSender( const std::string & sender )
     {
         std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
         
-        this->Log( source, Message::LevelCritical, fmt, ap );
+        if( sender.length() == 0 )
+        {
+            return;
+        }
+        
+        this->impl->_asl.AddSender( sender );
+        this->impl->_asl.Start();
     }
     
-    void Logger::Error( const char * fmt, ... )
+    #endif
+    
+    void Logger::Log( const Message & msg )
     {
-        va_list                                 ap;
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
-        
-        va_start( ap, fmt );
-        
-        this->Error( fmt, ap );
+        if( this->impl->Admit( msg.GetSource(), msg.GetLevel() ) == false )
+        {
+            return;
+        }
         
-        va_end( ap );
+        this->Ingest( msg );
     }
     
-    void Logger::Error( const char * fmt, va_list ap )
+    /* Admitted, but buffered for a request that didn't fail */
+    void Logger::Discard( const Message & msg )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        this->impl->_statistics.AddDrop( Statistics::DropDiscarded, msg.GetLevel() );
+        this->impl->_metrics.AddMessage( Metrics::StageDropped, msg.GetLevel() );
         
-        this->Error( Message::SourceCXX, fmt, ap );
+        ULOG_PROBE2( message_drop, static_cast< int >( msg.GetLevel() ), static_cast< int >( Statistics::DropDiscarded ) );
     }
     
-    void Logger::Error( Message::Source source, const char * fmt, ... )
+    /*
+     * Callers must not hold the logger lock here: a blocking backpressure
+     * policy waits for the worker, which needs it.
+     */
+    void Logger::Ingest( Message msg )
     {
-        va_list                                 ap;
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        RequestContext * context;
+        FlightRecorder * recorder;
+        unsigned int     signals;
         
-        va_start( ap, fmt );
+        context = RequestContext::GetCurrent();
         
-        this->Error( source, fmt, ap );
+        /* Buffered messages are accepted only if the request fails */
+        if( context != nullptr && context->Buffer( *( this ), msg ) )
+        {
+            return;
+        }
         
-        va_end( ap );
-    }
-    
-    void Logger::Error( Message::Source source, const char * fmt, va_list ap )
-    {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        this->impl->_metrics.AddMessage( Metrics::StageAccepted, msg.GetLevel() );
         
-        this->Log( source, Message::LevelError, fmt, ap );
+        signals = FlightRecorderSignals.load( std::memory_order_relaxed );
+        
+        if( signals != this->impl->_signals.load( std::memory_order_relaxed ) && this->impl->_signals.exchange( signals ) != signals )
+        {
+            this->DumpFlightRecorder();
+        }
+        
+        recorder = this->impl->_recorder.load( std::memory_order_acquire );
+        
+        if( recorder != nullptr )
+        {
+            /* Recorded messages are counted now (Statistics is lock-free), but only written on a dump */
+            if( msg.GetLevel() > this->impl->_recorderLevel )
+            {
+                this->impl->_statistics.Add( msg );
+                
+                msg.SetSequence( this->impl->_sequence.fetch_add( 1, std::memory_order_relaxed ) + 1 );
+                
+                recorder->Add( std::move( msg ) );
+                
+                return;
+            }
+            
+            if( msg.GetLevel() <= this->impl->_recorderTrigger )
+            {
+                this->DumpFlightRecorder();
+            }
+        }
+        
+        /*
+         * Severe messages skip the queue (and the dispatch queue on Apple),
+         * so they are on every sink before the call returns.
+         */
+        if( msg.GetLevel() <= this->impl->_priorityLevel )
+        {
+            std::unique_lock< std::recursive_mutex > l( Acquire( this->impl->_rmtx, this->impl->_metrics ) );
+            
+            this->impl->Process( msg );
+            
+            if( this->impl->_prioritySync )
+            {
+                this->impl->Sync();
+            }
+            
+            return;
+        }
+        
+        if( this->impl->Enqueue( msg ) )
+        {
+            return;
+        }
+        
+        #ifdef __APPLE__
+        
+        dispatch_async
+        (
+            this->impl->_queue,
+            ^( void )
+            {
+                Message                                 m( msg );
+                std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+                
+                this->impl->Process( m );
+            }
+        );
+        
+        #else
+        
+        std::unique_lock< std::recursive_mutex > l( Acquire( this->impl->_rmtx, this->impl->_metrics ) );
+        
+        this->impl->Process( msg );
+        
+        #endif
     }
     
-    void Logger::Warning( const char * fmt, ... )
+    void Logger::Log( const char * fmt, ... )
     {
-        va_list                                 ap;
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        va_list ap;
         
         va_start( ap, fmt );
         
-        this->Warning( fmt, ap );
+        this->Log( fmt, ap );
         
         va_end( ap );
     }
     
-    void Logger::Warning( const char * fmt, va_list ap )
+    void Logger::Log( const char * fmt, va_list ap )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
-        
-        this->Warning( Message::SourceCXX, fmt, ap );
+        this->Log( Message::LevelDebug, fmt, ap );
     }
     
-    void Logger::Warning( Message::Source source, const char * fmt, ... )
+    void Logger::Log( Message::Level level, const char * fmt, ... )
     {
-        va_list                                 ap;
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        va_list ap;
         
         va_start( ap, fmt );
         
-        this->Warning( source, fmt, ap );
+        this->Log( level, fmt, ap );
         
         va_end( ap );
     }
     
-    void Logger::Warning( Message::Source source, const char * fmt, va_list ap )
+    void Logger::Log( Message::Level level, const char * fmt, va_list ap )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
-        
-        this->Log( source, Message::LevelWarning, fmt, ap );
+        this->Log( Message::SourceCXX, level, fmt, ap );
     }
     
-    void Logger::Notice( const char * fmt, ... )
+    void Logger::Log( Message::Source source, Message::Level level, const char * fmt, ... )
     {
-        va_list                                 ap;
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        va_list ap;
         
         va_start( ap, fmt );
         
-        this->Notice( fmt, ap );
+        this->Log( source, level, fmt, ap );
         
         va_end( ap );
     }
     
-    void Logger::Notice( const char * fmt, va_list ap )
-    {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
-        
-        this->Notice( Message::SourceCXX, fmt, ap );
-    }
-    
-    void Logger::Notice( Message::Source source, const char * fmt, ... )
+    void Logger::Log( const CallSite & site, Message::Source source, const char * fmt, ... )
     {
-        va_list                                 ap;
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        va_list ap;
         
         va_start( ap, fmt );
         
-        this->Notice( source, fmt, ap );
+        this->Log( site, source, fmt, ap );
         
         va_end( ap );
     }
     
-    void Logger::Notice( Message::Source source, const char * fmt, va_list ap )
+    void Logger::Log( const CallSite & site, Message::Source source, const char * fmt, va_list ap )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        if( this->impl->Admit( source, site.GetLevel() ) == false )
+        {
+            return;
+        }
         
-        this->Log( source, Message::LevelNotice, fmt, ap );
+        {
+            Message msg( source, site.GetLevel(), fmt, ap );
+            
+            msg.SetCallSite( &site );
+            
+            this->Ingest( std::move( msg ) );
+        }
     }
     
-    void Logger::Info( const char * fmt, ... )
+    void Logger::Log( const Category & category, Message::Level level, const char * fmt, ... )
     {
-        va_list                                 ap;
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        va_list ap;
         
         va_start( ap, fmt );
         
-        this->Info( fmt, ap );
+        this->Log( category, level, fmt, ap );
         
         va_end( ap );
     }
     
-    void Logger::Info( const char * fmt, va_list ap )
+    void Logger::Log( const Category & category, Message::Level level, const char * fmt, va_list ap )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        if( category.IsEnabled( level ) == false )
+        {
+            this->impl->_metrics.AddMessage( Metrics::StageFiltered, level );
+            
+            ULOG_PROBE1( message_filter, static_cast< int >( level ) );
+            
+            return;
+        }
         
-        this->Info( Message::SourceCXX, fmt, ap );
+        if( this->impl->Admit( Message::SourceCXX, level ) == false )
+        {
+            return;
+        }
+        
+        {
+            Message msg( Message::SourceCXX, level, fmt, ap );
+            
+            msg.SetCategory( category.GetName() );
+            
+            this->Ingest( std::move( msg ) );
+        }
     }
     
-    void Logger::Info( Message::Source source, const char * fmt, ... )
+    void Logger::Log( const CallSite & site, const Category & category, Message::Source source, const char * fmt, ... )
     {
-        va_list                                 ap;
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        va_list ap;
         
         va_start( ap, fmt );
         
-        this->Info( source, fmt, ap );
+        this->Log( site, category, source, fmt, ap );
         
         va_end( ap );
     }
     
-    void Logger::Info( Message::Source source, const char * fmt, va_list ap )
+    /* The ULogCategory* macros have already checked the category's level */
+    void Logger::Log( const CallSite & site, const Category & category, Message::Source source, const char * fmt, va_list ap )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        if( this->impl->Admit( source, site.GetLevel() ) == false )
+        {
+            return;
+        }
         
-        this->Log( source, Message::LevelInfo, fmt, ap );
-    }
-    
-    void Logger::Debug( const char * fmt, ... )
+        {
+            Message msg( source, site.GetLevel(), fmt, ap );
+            
+            msg.SetCallSite( &site );
+            msg.SetCategory( category.GetName() );
+            
+            this->Ingest( std::move( msg ) );
+        }
+    }
+    
+    void Logger::Log( Message::Source source, Message::Level level, const char * fmt, va_list ap )
     {
-        va_list                                 ap;
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        /* Before formatting, so a rejected message costs next to nothing */
+        if( this->impl->Admit( source, level ) == false )
+        {
+            return;
+        }
+        
+        this->Ingest( Message( source, level, fmt, ap ) );
+    }
+    
+    void Logger::Emergency( const char * fmt, ... )
+    {
+        va_list ap;
         
         va_start( ap, fmt );
         
-        this->Debug( fmt, ap );
+        this->Emergency( fmt, ap );
         
         va_end( ap );
     }
     
-    void Logger::Debug( const char * fmt, va_list ap )
+    void Logger::Emergency( const char * fmt, va_list ap )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        this->Emergency( Message::SourceCXX, fmt, ap );
+    }
+    
+    void Logger::Emergency( Message::Source source, const char * fmt, ... )
+    {
+        va_list ap;
         
-        this->Debug( Message::SourceCXX, fmt, ap );
+        va_start( ap, fmt );
+        
+        this->Emergency( source, fmt, ap );
+        
+        va_end( ap );
     }
     
-    void Logger::Debug( Message::Source source, const char * fmt, ... )
+    void Logger::Emergency( Message::Source source, const char * fmt, va_list ap )
     {
-        va_list                                 ap;
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        this->Log( source, Message::LevelEmergency, fmt, ap );
+    }
+    
+    void Logger::Alert( const char * fmt, ... )
+    {
+        va_list ap;
         
         va_start( ap, fmt );
         
-        this->Debug( source, fmt, ap );
+        this->Alert( fmt, ap );
         
         va_end( ap );
     }
     
-    void Logger::Debug( Message::Source source, const char * fmt, va_list ap )
+    void Logger::Alert( const char * fmt, va_list ap )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        this->Alert( Message::SourceCXX, fmt, ap );
+    }
+    
+    void Logger::Alert( Message::Source source, const char * fmt, ... )
+    {
+        va_list ap;
         
-        this->Log( source, Message::LevelDebug, fmt, ap );
+        va_start( ap, fmt );
+        
+        this->Alert( source, fmt, ap );
+        
+        va_end( ap );
     }
     
-    std::vector< Message > Logger::GetMessages( void ) const
+    void Logger::Alert( Message::Source source, const char * fmt, va_list ap )
     {
-        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        this->Log( source, Message::LevelAlert, fmt, ap );
+    }
+    
+    void Logger::Critical( const char * fmt, ... )
+    {
+        va_list ap;
+        
+        va_start( ap, fmt );
+        
+        this->Critical( fmt, ap );
         
-        return this->impl->_messages;
+        va_end( ap );
     }
     
-    Logger::IMPL::IMPL( void ):
-        _displayOptions( DisplayOptionProcess | DisplayOptionTime | DisplayOptionSource | DisplayOptionLevel ),
-        _enabled( true )
+    void Logger::Critical( const char * fmt, va_list ap )
     {
-        #ifdef __APPLE__
+        this->Critical( Message::SourceCXX, fmt, ap );
+    }
+    
+    void Logger::Critical( Message::Source source, const char * fmt, ... )
+    {
+        va_list ap;
         
-        this->_queue = dispatch_queue_create( "ULog", DISPATCH_QUEUE_SERIAL );
+        va_start( ap, fmt );
         
-        #endif
+        this->Critical( source, fmt, ap );
+        
+        va_end( ap );
     }
     
-    Logger::IMPL::IMPL( const IMPL & o )
+    void Logger::Critical( Message::Source source, const char * fmt, va_list ap )
     {
-        std::lock_guard< std::recursive_mutex > l( o._rmtx );
+        this->Log( source, Message::LevelCritical, fmt, ap );
+    }
+    
+    void Logger::Error( const char * fmt, ... )
+    {
+        va_list ap;
         
-        this->_messages       = o._messages;
-        this->_enabled        = o._enabled;
-        this->_displayOptions = o._displayOptions;
-        this->_files          = o._files;
+        va_start( ap, fmt );
         
-        #ifdef __APPLE__
+        this->Error( fmt, ap );
         
-        this->_asl   = o._asl;
-        this->_queue = dispatch_queue_create( "ULog", DISPATCH_QUEUE_SERIAL );
+        va_end( ap );
+    }
+    
+    void Logger::Error( const char * fmt, va_list ap )
+    {
+        this->Error( Message::SourceCXX, fmt, ap );
+    }
+    
+    void Logger::Error( Message::Source source, const char * fmt, ... )
+    {
+        va_list ap;
         
-        #endif
+        va_start( ap, fmt );
+        
+        this->Error( source, fmt, ap );
+        
+        va_end( ap );
     }
     
-    Logger::IMPL::~IMPL( void )
+    void Logger::Error( Message::Source source, const char * fmt, va_list ap )
     {
-        #ifdef __APPLE__
+        this->Log( source, Message::LevelError, fmt, ap );
+    }
+    
+    void Logger::Warning( const char * fmt, ... )
+    {
+        va_list ap;
         
-        dispatch_release( this->_queue );
+        va_start( ap, fmt );
         
-        #endif
+        this->Warning( fmt, ap );
+        
+        va_end( ap );
+    }
+    
+    void Logger::Warning( const char * fmt, va_list ap )
+    {
+        this->Warning( Message::SourceCXX, fmt, ap );
+    }
+    
+    void Logger::Warning( Message::Source source, const char * fmt, ... )
+    {
+        va_list ap;
+        
+        va_start( ap, fmt );
+        
+        this->Warning( source, fmt, ap );
+        
+        va_end( ap );
+    }
+    
+    void Logger::Warning( Message::Source source, const char * fmt, va_list ap )
+    {
+        this->Log( source, Message::LevelWarning, fmt, ap );
+    }
+    
+    void Logger::Notice( const char * fmt, ... )
+    {
+        va_list ap;
+        
+        va_start( ap, fmt );
+        
+        this->Notice( fmt, ap );
+        
+        va_end( ap );
+    }
+    
+    void Logger::Notice( const char * fmt, va_list ap )
+    {
+        this->Notice( Message::SourceCXX, fmt, ap );
+    }
+    
+    void Logger::Notice( Message::Source source, const char * fmt, ... )
+    {
+        va_list ap;
+        
+        va_start( ap, fmt );
+        
+        this->Notice( source, fmt, ap );
+        
+        va_end( ap );
+    }
+    
+    void Logger::Notice( Message::Source source, const char * fmt, va_list ap )
+    {
+        this->Log( source, Message::LevelNotice, fmt, ap );
+    }
+    
+    void Logger::Info( const char * fmt, ... )
+    {
+        va_list ap;
+        
+        va_start( ap, fmt );
+        
+        this->Info( fmt, ap );
+        
+        va_end( ap );
+    }
+    
+    void Logger::Info( const char * fmt, va_list ap )
+    {
+        this->Info( Message::SourceCXX, fmt, ap );
+    }
+    
+    void Logger::Info( Message::Source source, const char * fmt, ... )
+    {
+        va_list ap;
+        
+        va_start( ap, fmt );
+        
+        this->Info( source, fmt, ap );
+        
+        va_end( ap );
+    }
+    
+    void Logger::Info( Message::Source source, const char * fmt, va_list ap )
+    {
+        this->Log( source, Message::LevelInfo, fmt, ap );
+    }
+    
+    void Logger::Debug( const char * fmt, ... )
+    {
+        va_list ap;
+        
+        va_start( ap, fmt );
+        
+        this->Debug( fmt, ap );
+        
+        va_end( ap );
+    }
+    
+    void Logger::Debug( const char * fmt, va_list ap )
+    {
+        this->Debug( Message::SourceCXX, fmt, ap );
+    }
+    
+    void Logger::Debug( Message::Source source, const char * fmt, ... )
+    {
+        va_list ap;
+        
+        va_start( ap, fmt );
+        
+        this->Debug( source, fmt, ap );
+        
+        va_end( ap );
+    }
+    
+    void Logger::Debug( Message::Source source, const char * fmt, va_list ap )
+    {
+        this->Log( source, Message::LevelDebug, fmt, ap );
+    }
+    
+    std::vector< Message > Logger::GetMessages( void ) const
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        
+        return std::vector< Message >( this->impl->_messages.begin(), this->impl->_messages.end() );
+    }
+    
+    std::vector< Message > Logger::GetMessages( const std::string & query, uint64_t options, uint64_t levelMask, uint64_t sourceMask ) const
+    {
+        std::lock_guard< std::recursive_mutex >        l( this->impl->_rmtx );
+        std::vector< Message >                         messages;
+        std::vector< std::vector< const Message * > >  matches;
+        std::vector< std::thread >                     workers;
+        size_t                                         n;
+        size_t                                         chunks;
+        size_t                                         count;
+        bool                                           ci;
+        
+        n      = this->impl->_messages.size();
+        ci     = ( options & SearchOptionCaseInsensitive ) != 0;
+        chunks = ( this->impl->_scanThreads > 0 ) ? this->impl->_scanThreads : std::thread::hardware_concurrency();
+        chunks = std::max< size_t >( 1, std::min( chunks, n / MinimumScanChunk ) );
+        
+        matches.resize( chunks );
+        
+        /*
+         * Each worker scans a contiguous slice of the history, so the slices
+         * concatenated in order are already in time order.
+         */
+        auto scan = [ & ]( size_t chunk )
+        {
+            std::deque< Message >::const_iterator it;
+            std::deque< Message >::const_iterator end;
+            
+            it  = this->impl->_messages.begin() + static_cast< std::ptrdiff_t >( ( n * chunk ) / chunks );
+            end = this->impl->_messages.begin() + static_cast< std::ptrdiff_t >( ( n * ( chunk + 1 ) ) / chunks );
+            
+            for( ; it != end; ++it )
+            {
+                if( ( levelMask & ( static_cast< uint64_t >( 1 ) << it->GetLevel() ) ) == 0 )
+                {
+                    continue;
+                }
+                
+                if( ( sourceMask & ( static_cast< uint64_t >( 1 ) << it->GetSource() ) ) == 0 )
+                {
+                    continue;
+                }
+                
+                if( Matches( *( it ), query, ci ) )
+                {
+                    matches[ chunk ].push_back( &( *( it ) ) );
+                }
+            }
+        };
+        
+        for( size_t i = 1; i < chunks; i++ )
+        {
+            try
+            {
+                workers.push_back( std::thread( scan, i ) );
+            }
+            catch( const std::system_error & )
+            {
+                scan( i );
+            }
+        }
+        
+        scan( 0 );
+        
+        for( auto & worker: workers )
+        {
+            worker.join();
+        }
+        
+        count = 0;
+        
+        for( const auto & chunk: matches )
+        {
+            count += chunk.size();
+        }
+        
+        messages.reserve( count );
+        
+        for( const auto & chunk: matches )
+        {
+            for( const auto m: chunk )
+            {
+                messages.push_back( *( m ) );
+            }
+        }
+        
+        return messages;
+    }
+    
+    std::vector< Message > Logger::GetMessages( uint64_t from, uint64_t to ) const
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::deque< Message >::const_iterator   begin;
+        std::deque< Message >::const_iterator   end;
+        
+        this->impl->GetRange( from, to, begin, end );
+        
+        return std::vector< Message >( begin, end );
+    }
+    
+    size_t Logger::CountMessages( uint64_t from, uint64_t to, uint64_t levelMask ) const
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::deque< Message >::const_iterator   begin;
+        std::deque< Message >::const_iterator   end;
+        size_t                                  n;
+        
+        this->impl->GetRange( from, to, begin, end );
+        
+        if( levelMask == ~static_cast< uint64_t >( 0 ) )
+        {
+            return static_cast< size_t >( end - begin );
+        }
+        
+        n = 0;
+        
+        for( ; begin != end; ++begin )
+        {
+            if( levelMask & ( static_cast< uint64_t >( 1 ) << begin->GetLevel() ) )
+            {
+                n++;
+            }
+        }
+        
+        return n;
+    }
+    
+    void Logger::VisitMessages( uint64_t from, uint64_t to, std::function< void( const Message & ) > f ) const
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::deque< Message >::const_iterator   begin;
+        std::deque< Message >::const_iterator   end;
+        
+        if( f == nullptr )
+        {
+            return;
+        }
+        
+        this->impl->GetRange( from, to, begin, end );
+        
+        for( ; begin != end; ++begin )
+        {
+            f( *( begin ) );
+        }
+    }
+    
+    uint64_t Logger::GetLastSequence( void ) const
+    {
+        return this->impl->_sequence.load( std::memory_order_relaxed );
+    }
+    
+    Statistics Logger::GetStatistics( void ) const
+    {
+        return this->impl->_statistics;
+    }
+    
+    Metrics Logger::GetMetrics( void ) const
+    {
+        return this->impl->_metrics;
+    }
+    
+    std::vector< Message > Logger::GetMessagesSince( uint64_t sequence, size_t max, uint64_t & next ) const
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::vector< Message >                  messages;
+        size_t                                  n;
+        size_t                                  t;
+        
+        next = sequence;
+        n    = this->impl->_messages.size();
+        t    = this->impl->_tail;
+        
+        if( sequence >= this->impl->_sequence.load( std::memory_order_relaxed ) )
+        {
+            return messages;
+        }
+        
+        /*
+         * The last _tail messages were appended in sequence order after
+         * everything else, so a reader that keeps up only needs a binary
+         * search over them.
+         */
+        if( t == n || ( t > 0 && sequence + 1 >= this->impl->_messages[ n - t ].GetSequence() ) )
+        {
+            std::deque< Message >::const_iterator it;
+            
+            it = std::upper_bound
+            (
+                this->impl->_messages.end() - static_cast< std::ptrdiff_t >( t ),
+                this->impl->_messages.end(),
+                sequence,
+                []( uint64_t seq, const Message & m ) -> bool
+                {
+                    return seq < m.GetSequence();
+                }
+            );
+            
+            for( ; it != this->impl->_messages.end() && ( max == 0 || messages.size() < max ); ++it )
+            {
+                messages.push_back( *( it ) );
+            }
+        }
+        else
+        {
+            for( const auto & m: this->impl->_messages )
+            {
+                if( m.GetSequence() > sequence )
+                {
+                    messages.push_back( m );
+                }
+            }
+            
+            std::sort
+            (
+                messages.begin(),
+                messages.end(),
+                []( const Message & m1, const Message & m2 ) -> bool
+                {
+                    return m1.GetSequence() < m2.GetSequence();
+                }
+            );
+            
+            if( max != 0 && messages.size() > max )
+            {
+                messages.erase( messages.begin() + static_cast< std::ptrdiff_t >( max ), messages.end() );
+            }
+        }
+        
+        if( messages.size() > 0 )
+        {
+            next = messages.back().GetSequence();
+        }
+        
+        return messages;
+    }
+    
+    std::vector< uint64_t > Logger::Search( const std::string & query, uint64_t options ) const
+    {
+        std::lock_guard< std::recursive_mutex > l( this->impl->_rmtx );
+        std::vector< uint64_t >                 sequences;
+        std::vector< SearchIndex::Key >         keys;
+        bool                                    ci;
+        
+        ci = ( options & SearchOptionCaseInsensitive ) != 0;
+        
+        if( query.length() < SearchIndex::MinimumQueryLength )
+        {
+            for( const auto & m: this->impl->_messages )
+            {
+                if( Matches( m, query, ci ) )
+                {
+                    sequences.push_back( m.GetSequence() );
+                }
+            }
+            
+            return sequences;
+        }
+        
+        /* Built on first use, then maintained as messages are logged */
+        if( this->impl->_indexed == false )
+        {
+            this->impl->BuildIndex();
+        }
+        
+        for( const auto & key: this->impl->_index.GetCandidates( query ) )
+        {
+            std::deque< Message >::const_iterator it;
+            
+            it = std::lower_bound
+            (
+                this->impl->_messages.begin(),
+                this->impl->_messages.end(),
+                key,
+                []( const Message & m, const SearchIndex::Key & k ) -> bool
+                {
+                    return SearchIndex::GetKey( m ) < k;
+                }
+            );
+            
+            if( it != this->impl->_messages.end() && it->GetSequence() == key.second && Matches( *( it ), query, ci ) )
+            {
+                keys.push_back( key );
+            }
+        }
+        
+        std::sort( keys.begin(), keys.end() );
+        
+        sequences.reserve( keys.size() );
+        
+        for( const auto & key: keys )
+        {
+            sequences.push_back( key.second );
+        }
+        
+        return sequences;
+    }
+    
+    Logger::IMPL::IMPL( void ):
+        _displayOptions( DisplayOptionProcess | DisplayOptionTime | DisplayOptionSource | DisplayOptionLevel ),
+        _format( FormatText ),
+        _enabled( true ),
+        _limited( false ),
+        _sequence( 0 ),
+        _tail( 0 ),
+        _historyLimit( 0 ),
+        _scanThreads( 0 ),
+        _indexed( false ),
+        _deduplicationWindow( 0 ),
+        _hasLast( false ),
+        _lastSource( Message::SourceCXX ),
+        _lastLevel( Message::LevelDebug ),
+        _repeats( 0 ),
+        _runStart( 0 ),
+        _random( 0x9E3779B97F4A7C15ULL ),
+        _capacity( 0 ),
+        _backpressure( BackpressureBlock ),
+        _backpressureTimeout( 0 ),
+        _backpressureLevel( Message::LevelError ),
+        _dropped( 0 ),
+        _busy( false ),
+        _stop( false ),
+        _priorityLevel( Message::LevelCritical ),
+        _prioritySync( false ),
+        _recorder( nullptr ),
+        _recorderLevel( Message::LevelNotice ),
+        _recorderTrigger( Message::LevelError ),
+        _signals( FlightRecorderSignals.load() )
+    {
+        Limit none;
+        
+        none.sampling = 0;
+        none.rate     = 0;
+        none.burst    = 0;
+        none.tokens   = 0;
+        
+        std::fill( std::begin( this->_levelLimits ),  std::end( this->_levelLimits ),  none );
+        std::fill( std::begin( this->_sourceLimits ), std::end( this->_sourceLimits ), none );
+        
+        #ifdef __APPLE__
+        
+        this->_queue = dispatch_queue_create( "ULog", DISPATCH_QUEUE_SERIAL );
+        
+        #endif
+    }
+    
+    Logger::IMPL::IMPL( const IMPL & o )
+    {
+        std::lock_guard< std::recursive_mutex > l( o._rmtx );
+        
+        this->_messages            = o._messages;
+        this->_enabled             = o._enabled.load();
+        this->_limited             = o._limited.load();
+        this->_displayOptions      = o._displayOptions;
+        this->_format              = o._format;
+        this->_sequence            = o._sequence.load();
+        this->_tail                = o._tail;
+        this->_historyLimit        = o._historyLimit;
+        this->_scanThreads         = o._scanThreads;
+        this->_index               = o._index;
+        this->_indexed             = o._indexed;
+        this->_statistics          = o._statistics;
+        this->_metrics             = o._metrics;
+        this->_deduplicationWindow = o._deduplicationWindow;
+        this->_hasLast             = o._hasLast;
+        this->_lastSource          = o._lastSource;
+        this->_lastLevel           = o._lastLevel;
+        this->_lastText            = o._lastText;
+        this->_repeats             = o._repeats;
+        this->_runStart            = o._runStart;
+        this->_random              = o._random;
+        this->_files               = o._files;
+        this->_priorityLevel       = o._priorityLevel.load();
+        this->_prioritySync        = o._prioritySync.load();
+        this->_recorder            = nullptr;
+        this->_recorderLevel       = o._recorderLevel.load();
+        this->_recorderTrigger     = o._recorderTrigger.load();
+        this->_signals             = o._signals.load();
+        
+        if( o._recorder.load() != nullptr )
+        {
+            this->_recorders.emplace_back( new FlightRecorder( *( o._recorder.load() ) ) );
+            
+            this->_recorder = this->_recorders.back().get();
+        }
+        
+        std::copy( std::begin( o._levelLimits ),  std::end( o._levelLimits ),  std::begin( this->_levelLimits ) );
+        std::copy( std::begin( o._sourceLimits ), std::end( o._sourceLimits ), std::begin( this->_sourceLimits ) );
+        
+        {
+            std::lock_guard< std::mutex > q( o._qmtx );
+            
+            this->_capacity            = o._capacity.load();
+            this->_backpressure        = o._backpressure;
+            this->_backpressureTimeout = o._backpressureTimeout;
+            this->_backpressureLevel   = o._backpressureLevel;
+            this->_dropped             = 0;
+            this->_busy                = false;
+            this->_stop                = false;
+        }
+        
+        if( this->_capacity > 0 )
+        {
+            this->Start();
+        }
+        
+        #ifdef __APPLE__
+        
+        this->_asl   = o._asl;
+        this->_queue = dispatch_queue_create( "ULog", DISPATCH_QUEUE_SERIAL );
+        
+        #endif
+    }
+    
+    Logger::IMPL::~IMPL( void )
+    {
+        this->Stop();
+        
+        #ifdef __APPLE__
+        
+        dispatch_release( this->_queue );
+        
+        #endif
+    }
+    
+    void Logger::IMPL::Trim( void )
+    {
+        if( this->_historyLimit == 0 )
+        {
+            return;
+        }
+        
+        while( this->_messages.size() > this->_historyLimit )
+        {
+            if( this->_indexed )
+            {
+                this->_index.Remove( this->_messages.front() );
+            }
+            
+            this->_messages.pop_front();
+        }
+        
+        this->_tail = std::min( this->_tail, this->_messages.size() );
+    }
+    
+    /*
+     * Takes the logger lock only when sampling or rate limits are
+     * configured; otherwise admission is two relaxed loads.
+     */
+    bool Logger::IMPL::Admit( Message::Source source, Message::Level level )
+    {
+        std::chrono::steady_clock::time_point now;
+        
+        if( this->_enabled.load( std::memory_order_relaxed ) == false )
+        {
+            this->_metrics.AddMessage( Metrics::StageFiltered, level );
+            
+            ULOG_PROBE1( message_filter, static_cast< int >( level ) );
+            
+            return false;
+        }
+        
+        if( this->_limited.load( std::memory_order_relaxed ) == false )
+        {
+            return true;
+        }
+        
+        if( static_cast< size_t >( level ) >= LevelCount || static_cast< size_t >( source ) >= SourceCount )
+        {
+            return true;
+        }
+        
+        std::unique_lock< std::recursive_mutex > lock( Acquire( this->_rmtx, this->_metrics ) );
+        
+        Limit & l = this->_levelLimits[ level ];
+        Limit & s = this->_sourceLimits[ source ];
+        
+        /* Sampled out messages don't consume rate limit tokens */
+        if( this->Sample( l ) == false || this->Sample( s ) == false )
+        {
+            this->_statistics.AddDrop( Statistics::DropSampled, level );
+            this->_metrics.AddMessage( Metrics::StageFiltered, level );
+            
+            ULOG_PROBE1( message_filter, static_cast< int >( level ) );
+            
+            return false;
+        }
+        
+        if( l.rate <= 0 && s.rate <= 0 )
+        {
+            return true;
+        }
+        
+        now = std::chrono::steady_clock::now();
+        
+        Refill( l, now );
+        Refill( s, now );
+        
+        if( ( l.rate > 0 && l.tokens < 1 ) || ( s.rate > 0 && s.tokens < 1 ) )
+        {
+            this->_statistics.AddDrop( Statistics::DropRateLimited, level );
+            this->_metrics.AddMessage( Metrics::StageFiltered, level );
+            
+            ULOG_PROBE1( message_filter, static_cast< int >( level ) );
+            
+            return false;
+        }
+        
+        if( l.rate > 0 )
+        {
+            l.tokens -= 1;
+        }
+        
+        if( s.rate > 0 )
+        {
+            s.tokens -= 1;
+        }
+        
+        return true;
+    }
+    
+    void Logger::IMPL::UpdateLimited( void )
+    {
+        bool limited;
+        
+        limited = false;
+        
+        for( const Limit & limit: this->_levelLimits )
+        {
+            limited = limited || limit.sampling > 1 || limit.rate > 0;
+        }
+        
+        for( const Limit & limit: this->_sourceLimits )
+        {
+            limited = limited || limit.sampling > 1 || limit.rate > 0;
+        }
+        
+        this->_limited.store( limited, std::memory_order_relaxed );
+    }
+    
+    bool Logger::IMPL::Sample( const Limit & limit )
+    {
+        if( limit.sampling <= 1 )
+        {
+            return true;
+        }
+        
+        /* xorshift64 */
+        this->_random ^= this->_random << 13;
+        this->_random ^= this->_random >> 7;
+        this->_random ^= this->_random << 17;
+        
+        return this->_random % limit.sampling == 0;
+    }
+    
+    void Logger::IMPL::Process( Message & m )
+    {
+        if( this->_enabled == false )
+        {
+            this->_metrics.AddMessage( Metrics::StageFiltered, m.GetLevel() );
+            
+            ULOG_PROBE1( message_filter, static_cast< int >( m.GetLevel() ) );
+            
+            return;
+        }
+        
+        this->_statistics.Add( m );
+        
+        if( this->_deduplicationWindow > 0 && this->Deduplicate( m ) )
+        {
+            this->_metrics.AddMessage( Metrics::StageFiltered, m.GetLevel() );
+            
+            ULOG_PROBE1( message_filter, static_cast< int >( m.GetLevel() ) );
+            
+            return;
+        }
+        
+        this->Write( m, false );
+    }
+    
+    void Logger::IMPL::Write( Message & m, bool stamped )
+    {
+        std::string s;
+        
+        /*
+         * Stamped inside the ingestion critical section, so sequence order
+         * is the order of logging calls and ties on the clock are broken by
+         * Message::operator<. Recorded messages were stamped when logged.
+         */
+        if( stamped == false )
+        {
+            m.SetSequence( this->_sequence.fetch_add( 1, std::memory_order_relaxed ) + 1 );
+        }
+        
+        if( this->_format == FormatJSON )
+        {
+            Encoder::EncodeJSON( m, s );
+        }
+        else if( this->_format == FormatLogfmt )
+        {
+            Encoder::EncodeLogfmt( m, s );
+        }
+        else
+        {
+            if( this->_displayOptions & DisplayOptionProcess )
+            {
+                s += "[ " + m.GetProcessString() + " ]> ";
+            }
+            
+            if( this->_displayOptions & DisplayOptionTime )
+            {
+                s += "[ " + m.GetTimeString() + " ]> ";
+            }
+            
+            if( this->_displayOptions & DisplayOptionSource )
+            {
+                s += "[ " + m.GetSourceString() + " ]> ";
+            }
+            
+            if( this->_displayOptions & DisplayOptionLevel )
+            {
+                s += "[ " + m.GetLevelString() + " ]> ";
+            }
+            
+            s += m.GetText();
+        }
+        
+        if( m.GetSource() != Message::SourceASL )
+        {
+            #ifdef _WIN32
+            
+            OutputDebugStringA( s.c_str() );
+            OutputDebugStringA( "\n" );
+            
+            /* Detects if we run in console... */
+            {
+                SHFILEINFOA fi;
+                char        proc[ MAX_PATH ];
+                DWORD_PTR   hr;
+
+                memset( proc, 0, MAX_PATH );
+                GetModuleFileNameA( NULL, proc, MAX_PATH );
+
+                if( strlen( proc ) == 0 )
+                {
+                    return;
+                }
+
+                hr = SHGetFileInfoA( proc, 0, &fi, 0, SHGFI_EXETYPE );
+
+                if( ( hr & 0xFFFF ) == IMAGE_NT_SIGNATURE && ( ( hr >> 16 ) & 0xFFFF ) == 0 )
+                {
+                    this->WriteTo( Metrics::SinkConsole, std::cerr, s );
+                }
+            }
+
+            #else
+            
+            this->WriteTo( Metrics::SinkConsole, std::cerr, s );
+            
+            #endif
+        }
+        
+        for( const auto & k: this->_files )
+        {
+            this->WriteTo( Metrics::SinkFiles, *( k.second ), s );
+        }
+        
+        this->_metrics.AddMessage( Metrics::StageWritten, m.GetLevel() );
+        
+        ULOG_PROBE3( message_write, static_cast< int >( m.GetLevel() ), m.GetSequence(), s.length() );
+        
+        {
+            std::deque< Message >::iterator it;
+            
+            /*
+             * History stays sorted by ( time, sequence ): this is almost
+             * always an append, and only an out of order message (ASL)
+             * lands before the end.
+             */
+            it = std::upper_bound( this->_messages.begin(), this->_messages.end(), m );
+            
+            /* A recorded message is older than the tail's sequences */
+            if( it == this->_messages.end() && stamped == false )
+            {
+                this->_tail++;
+            }
+            else
+            {
+                this->_tail = 0;
+            }
+            
+            if( this->_indexed && this->_index.Add( m ) == false )
+            {
+                this->_index.Clear();
+                
+                this->_indexed = false;
+            }
+            
+            this->_messages.insert( it, std::move( m ) );
+            
+            this->Trim();
+        }
+    }
+    
+    void Logger::IMPL::WriteTo( Metrics::Sink sink, std::ostream & os, const std::string & s )
+    {
+        auto start = std::chrono::steady_clock::now();
+        
+        uint64_t ns;
+        
+        os << s << std::endl;
+        
+        ns = static_cast< uint64_t >( std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - start ).count() );
+        
+        this->_metrics.AddWrite( sink, s.length() + 1, ns );
+        
+        ULOG_PROBE3( sink_write, static_cast< int >( sink ), s.length() + 1, ns );
+    }
+    
+    bool Logger::IMPL::Deduplicate( const Message & m )
+    {
+        bool repeat;
+        
+        repeat = this->_hasLast
+              && this->_lastLevel  == m.GetLevel()
+              && this->_lastSource == m.GetSource()
+              && this->_lastText   == m.GetText();
+        
+        /*
+         * A run is summarized when it ends, or once it has lasted a whole
+         * window, so a flood still shows up at a bounded rate.
+         */
+        if( this->_repeats > 0 && ( repeat == false || GetTimestamp( m ) >= this->_runStart + this->_deduplicationWindow ) )
+        {
+            this->FlushRepeats();
+        }
+        
+        if( repeat == false )
+        {
+            /* Only what the comparison needs; the text buffer is reused */
+            this->_hasLast    = true;
+            this->_lastSource = m.GetSource();
+            this->_lastLevel  = m.GetLevel();
+            this->_lastText.assign( m.GetText() );
+            
+            return false;
+        }
+        
+        if( this->_repeats == 0 )
+        {
+            this->_runStart = GetTimestamp( m );
+        }
+        
+        this->_repeats++;
+        
+        return true;
+    }
+    
+    void Logger::IMPL::FlushRepeats( void )
+    {
+        uint64_t n;
+        
+        if( this->_repeats == 0 || this->_hasLast == false )
+        {
+            return;
+        }
+        
+        n              = this->_repeats;
+        this->_repeats = 0;
+        
+        {
+            Message summary( this->_lastSource, this->_lastLevel, "last message repeated " + std::to_string( n ) + ( ( n == 1 ) ? " time" : " times" ) );
+            
+            summary.AddField( "repeated", std::to_string( n ) );
+            
+            this->Write( summary, false );
+        }
+    }
+    
+    bool Logger::IMPL::Enqueue( Message & m )
+    {
+        std::chrono::steady_clock::time_point deadline;
+        
+        /* Synchronous mode never touches the queue lock */
+        if( this->_capacity.load( std::memory_order_relaxed ) == 0 )
+        {
+            return false;
+        }
+        
+        std::unique_lock< std::mutex > l( Acquire( this->_qmtx, this->_metrics ) );
+        
+        if( this->_capacity == 0 )
+        {
+            return false;
+        }
+        
+        deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds( this->_backpressureTimeout );
+        
+        while( this->_pending.size() >= this->_capacity )
+        {
+            if( this->_backpressure == BackpressureDropNewest )
+            {
+                this->Drop( Statistics::DropNewest, m.GetLevel() );
+                
+                return true;
+            }
+            
+            if( this->_backpressure == BackpressureDropOldest )
+            {
+                this->Drop( Statistics::DropOldest, this->_pending.front().GetLevel() );
+                this->_pending.pop_front();
+                
+                continue;
+            }
+            
+            if( this->_backpressure == BackpressureDropBelowLevel )
+            {
+                std::deque< Message >::iterator it;
+                
+                if( m.GetLevel() > this->_backpressureLevel )
+                {
+                    this->Drop( Statistics::DropBelowLevel, m.GetLevel() );
+                    
+                    return true;
+                }
+                
+                /* Severe enough to keep: make room by evicting a lesser one */
+                it = std::find_if
+                (
+                    this->_pending.begin(),
+                    this->_pending.end(),
+                    [ this ]( const Message & pending ) -> bool
+                    {
+                        return pending.GetLevel() > this->_backpressureLevel;
+                    }
+                );
+                
+                if( it != this->_pending.end() )
+                {
+                    this->Drop( Statistics::DropBelowLevel, it->GetLevel() );
+                    this->_pending.erase( it );
+                    
+                    continue;
+                }
+                
+                this->_notFull.wait( l );
+            }
+            else if( this->_backpressureTimeout == 0 )
+            {
+                this->_notFull.wait( l );
+            }
+            else if( this->_notFull.wait_until( l, deadline ) == std::cv_status::timeout && this->_pending.size() >= this->_capacity )
+            {
+                this->Drop( Statistics::DropTimeout, m.GetLevel() );
+                
+                return true;
+            }
+            
+            /* Switched back to synchronous logging while waiting */
+            if( this->_capacity == 0 )
+            {
+                return false;
+            }
+        }
+        
+        ULOG_PROBE2( message_enqueue, static_cast< int >( m.GetLevel() ), this->_pending.size() + 1 );
+        
+        this->_pending.push_back( std::move( m ) );
+        this->_metrics.SetQueueDepth( this->_pending.size() );
+        
+        l.unlock();
+        
+        this->_notEmpty.notify_one();
+        
+        return true;
+    }
+    
+    void Logger::IMPL::Drop( Statistics::Drop reason, Message::Level level )
+    {
+        this->_statistics.AddDrop( reason, level );
+        this->_metrics.AddMessage( Metrics::StageDropped, level );
+        
+        ULOG_PROBE2( message_drop, static_cast< int >( level ), static_cast< int >( reason ) );
+        
+        this->_dropped++;
+    }
+    
+    void Logger::IMPL::WriteDropMarker( uint64_t n )
+    {
+        Message marker( Message::SourceCXX, Message::LevelWarning, std::to_string( n ) + ( ( n == 1 ) ? " message dropped" : " messages dropped" ) );
+        
+        marker.AddField( "dropped", std::to_string( n ) );
+        
+        this->Process( marker );
+    }
+    
+    void Logger::IMPL::Start( void )
+    {
+        if( this->_worker.joinable() == false )
+        {
+            this->_worker = std::thread( &IMPL::Run, this );
+        }
+    }
+    
+    void Logger::IMPL::Stop( void )
+    {
+        std::thread worker;
+        
+        /* Taken under the lock, so concurrent calls can't both join it */
+        {
+            std::lock_guard< std::mutex > l( this->_qmtx );
+            
+            if( this->_worker.joinable() == false )
+            {
+                return;
+            }
+            
+            worker          = std::move( this->_worker );
+            this->_stop     = true;
+            this->_capacity = 0;
+        }
+        
+        this->_notEmpty.notify_all();
+        this->_notFull.notify_all();
+        worker.join();
+        
+        {
+            std::lock_guard< std::mutex > l( this->_qmtx );
+            
+            this->_stop = false;
+        }
+        
+        this->Drain();
+    }
+    
+    void Logger::IMPL::Run( void )
+    {
+        std::deque< Message > batch;
+        uint64_t              dropped;
+        
+        while( 1 )
+        {
+            {
+                std::unique_lock< std::mutex >        l( this->_qmtx );
+                std::chrono::steady_clock::time_point now;
+                
+                this->_notEmpty.wait
+                (
+                    l,
+                    [ this ]( void ) -> bool
+                    {
+                        return this->_pending.size() > 0 || this->_stop;
+                    }
+                );
+                
+                if( this->_pending.size() == 0 )
+                {
+                    break;
+                }
+                
+                batch.swap( this->_pending );
+                this->_metrics.SetQueueDepth( 0 );
+                
+                now     = std::chrono::steady_clock::now();
+                dropped = 0;
+                
+                /* At most one marker per second while messages are dropped */
+                if( this->_dropped > 0 && now - this->_dropMarker >= std::chrono::seconds( 1 ) )
+                {
+                    dropped           = this->_dropped;
+                    this->_dropped    = 0;
+                    this->_dropMarker = now;
+                }
+                
+                this->_busy = true;
+            }
+            
+            this->_notFull.notify_all();
+            
+            /*
+             * The lock is released between slices, so a priority message
+             * never waits for a whole batch.
+             */
+            for( size_t i = 0; i < batch.size(); i += BatchSlice )
+            {
+                std::unique_lock< std::recursive_mutex > l( Acquire( this->_rmtx, this->_metrics ) );
+                
+                if( i == 0 && dropped > 0 )
+                {
+                    this->WriteDropMarker( dropped );
+                }
+                
+                for( size_t j = i; j < std::min( i + BatchSlice, batch.size() ); j++ )
+                {
+                    this->Process( batch[ j ] );
+                }
+            }
+            
+            batch.clear();
+            
+            {
+                std::lock_guard< std::mutex > l( this->_qmtx );
+                
+                this->_busy = false;
+            }
+            
+            this->_idle.notify_all();
+        }
+    }
+    
+    void Logger::IMPL::Drain( void )
+    {
+        uint64_t dropped;
+        
+        {
+            std::unique_lock< std::mutex > l( this->_qmtx );
+            
+            this->_idle.wait
+            (
+                l,
+                [ this ]( void ) -> bool
+                {
+                    return this->_pending.size() == 0 && this->_busy == false;
+                }
+            );
+            
+            dropped        = this->_dropped;
+            this->_dropped = 0;
+        }
+        
+        if( dropped > 0 )
+        {
+            std::lock_guard< std::recursive_mutex > l( this->_rmtx );
+            
+            this->WriteDropMarker( dropped );
+        }
+    }
+    
+    /*
+     * Streams are flushed on every line, so only the OS cache is left:
+     * the file is reopened to reach it, as std::fstream hides its descriptor.
+     */
+    void Logger::IMPL::Sync( void )
+    {
+        for( const auto & k: this->_files )
+        {
+            int fd;
+            
+            k.second->flush();
+            
+            #if defined( _WIN32 )
+            
+            fd = _open( k.first.c_str(), _O_WRONLY | _O_APPEND );
+            
+            if( fd >= 0 )
+            {
+                _commit( fd );
+                _close( fd );
+            }
+            
+            #else
+            
+            fd = open( k.first.c_str(), O_WRONLY | O_APPEND );
+            
+            if( fd >= 0 )
+            {
+                #ifdef F_FULLFSYNC
+                
+                if( fcntl( fd, F_FULLFSYNC ) != 0 )
+                {
+                    fsync( fd );
+                }
+                
+                #else
+                
+                fsync( fd );
+                
+                #endif
+                
+                close( fd );
+            }
+            
+            #endif
+        }
+    }
+    
+    /*
+     * Recorded messages already went through admission and statistics, so
+     * they are written directly, in the order they were logged and with the
+     * sequence they got then.
+     */
+    void Logger::IMPL::Dump( void )
+    {
+        FlightRecorder * recorder;
+        
+        recorder = this->_recorder.load( std::memory_order_acquire );
+        
+        if( recorder == nullptr )
+        {
+            return;
+        }
+        
+        for( auto & m: recorder->Drain() )
+        {
+            this->Write( m, true );
+        }
+    }
+    
+    void Logger::IMPL::GetRange( uint64_t from, uint64_t to, std::deque< Message >::const_iterator & begin, std::deque< Message >::const_iterator & end ) const
+    {
+        auto before = []( const Message & m, uint64_t time ) -> bool
+        {
+            return GetTimestamp( m ) < time;
+        };
+        
+        /* History is sorted by time, so both bounds are binary searches */
+        begin = std::lower_bound( this->_messages.begin(), this->_messages.end(), from, before );
+        end   = ( to > from ) ? std::lower_bound( begin, this->_messages.end(), to, before ) : begin;
+    }
+    
+    void Logger::IMPL::BuildIndex( void )
+    {
+        std::vector< const Message * > messages;
+        
+        this->_index.Clear();
+        
+        for( const auto & m: this->_messages )
+        {
+            messages.push_back( &m );
+        }
+        
+        std::sort
+        (
+            messages.begin(),
+            messages.end(),
+            []( const Message * m1, const Message * m2 ) -> bool
+            {
+                return m1->GetSequence() < m2->GetSequence();
+            }
+        );
+        
+        for( const auto m: messages )
+        {
+            this->_index.Add( *( m ) );
+        }
+        
+        this->_indexed = true;
     }
 }
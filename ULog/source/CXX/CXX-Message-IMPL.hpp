@@ -0,0 +1,84 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+/*!
+ * @header      CXX-Message-IMPL.hpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#ifndef ULOG_CXX_MESSAGE_IMPL_H
+#define ULOG_CXX_MESSAGE_IMPL_H
+
+#include <ULog/ULog.h>
+#include <string>
+#include <vector>
+#include <cstdarg>
+#include <cstdint>
+
+/* Internal to the library, and shared with the benchmarks */
+namespace ULog
+{
+    class Message::IMPL
+    {
+        public:
+            
+            IMPL( void );
+            IMPL( Source source, Level level, const std::string & message );
+            IMPL( const IMPL & o );
+            
+            ~IMPL( void );
+            
+            Source               _source;
+            Level                _level;
+            std::string          _message;
+            std::string          _timeString;
+            uint64_t             _time;
+            uint64_t             _milliseconds;
+            uint64_t             _pid;
+            uint64_t             _tid;
+            uint64_t             _sequence;
+            std::vector< Field > _fields;
+            const CallSite     * _site;
+            Context              _context;
+            const char         * _category;
+            
+            void        SetTimeToCurrent( void );
+            void        SetProcessToCurrent( void );
+            void        SetThreadToCurrent( void );
+            std::string GetStringWithFormat( const char * fmt, va_list ap );
+            std::string GetTimeString( uint64_t time, uint64_t msec );
+            
+            static uint64_t GetCurrentThreadID( void );
+    };
+    
+    /* Message::IMPL is private: code outside Message names it through here */
+    class MessageAccess
+    {
+        public:
+            
+            typedef Message::IMPL IMPL;
+    };
+}
+
+#endif /* ULOG_CXX_MESSAGE_IMPL_H */
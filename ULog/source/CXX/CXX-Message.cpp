@@ -28,6 +28,8 @@
  */
 
 #include <ULog/ULog.h>
+#include "CXX-Probes.hpp"
+#include "CXX-Message-IMPL.hpp"
 #include <algorithm>
 #include <cstdlib>
 #include <iostream>
@@ -47,34 +49,10 @@
 
 namespace ULog
 {
-    class Message::IMPL
-    {
-        public:
-            
-            IMPL( void );
-            IMPL( Source source, Level level, const std::string & message );
-            IMPL( const IMPL & o );
-            
-            ~IMPL( void );
-            
-            Source      _source;
-            Level       _level;
-            std::string _message;
-            std::string _timeString;
-            uint64_t    _time;
-            uint64_t    _milliseconds;
-            uint64_t    _pid;
-            uint64_t    _tid;
-            
-            void        SetTimeToCurrent( void );
-            void        SetProcessToCurrent( void );
-            void        SetThreadToCurrent( void );
-            std::string GetStringWithFormat( const char * fmt, va_list ap );
-            std::string GetTimeString( uint64_t time, uint64_t msec );
-    };
-    
     Message::Message( Source source, Level level, const std::string & message ): impl( new IMPL( source, level, message ) )
-    {}
+    {
+        ULOG_PROBE3( message_create, static_cast< int >( level ), static_cast< int >( source ), message.length() );
+    }
     
     Message::Message( Source source, Level level, const char * fmt, ... ): impl( new IMPL )
     {
@@ -87,6 +65,8 @@ namespace ULog
         this->impl->_message = this->impl->GetStringWithFormat( fmt, ap );
         
         va_end( ap );
+        
+        ULOG_PROBE3( message_create, static_cast< int >( level ), static_cast< int >( source ), this->impl->_message.length() );
     }
     
     Message::Message( Source source, Level level, const char * fmt, va_list ap ): impl( new IMPL )
@@ -94,6 +74,8 @@ namespace ULog
         this->impl->_source  = source;
         this->impl->_level   = level;
         this->impl->_message = this->impl->GetStringWithFormat( fmt, ap );
+        
+        ULOG_PROBE3( message_create, static_cast< int >( level ), static_cast< int >( source ), this->impl->_message.length() );
     }
     
     Message::Message( const Message & o ): impl( new IMPL( *( o.impl ) ) )
@@ -122,6 +104,7 @@ namespace ULog
         this->impl->_milliseconds   = 0;
         this->impl->_pid            = 0;
         this->impl->_tid            = 0;
+        this->impl->_sequence       = 0;
         
         if( ( cp = asl_get( m, ASL_KEY_MSG ) ) )
         {
@@ -213,11 +196,21 @@ namespace ULog
             return false;
         }
         
+        if( this->impl->_sequence != o.impl->_sequence )
+        {
+            return false;
+        }
+        
         if( this->impl->_message != o.impl->_message )
         {
             return false;
         }
         
+        if( this->impl->_fields != o.impl->_fields )
+        {
+            return false;
+        }
+        
         return true;
     }
     
@@ -243,6 +236,16 @@ namespace ULog
             return true;
         }
         
+        if( this->impl->_milliseconds < o.impl->_milliseconds )
+        {
+            return false;
+        }
+        
+        if( this->impl->_sequence > o.impl->_sequence )
+        {
+            return true;
+        }
+        
         return false;
     }
     
@@ -253,7 +256,7 @@ namespace ULog
             return true;
         }
         
-        if( this->impl->_time == o.impl->_time && this->impl->_milliseconds == o.impl->_milliseconds )
+        if( this->impl->_time == o.impl->_time && this->impl->_milliseconds == o.impl->_milliseconds && this->impl->_sequence == o.impl->_sequence )
         {
             return true;
         }
@@ -278,6 +281,16 @@ namespace ULog
             return true;
         }
         
+        if( this->impl->_milliseconds > o.impl->_milliseconds )
+        {
+            return false;
+        }
+        
+        if( this->impl->_sequence < o.impl->_sequence )
+        {
+            return true;
+        }
+        
         return false;
     }
     
@@ -288,7 +301,7 @@ namespace ULog
             return true;
         }
         
-        if( this->impl->_time == o.impl->_time && this->impl->_milliseconds == o.impl->_milliseconds )
+        if( this->impl->_time == o.impl->_time && this->impl->_milliseconds == o.impl->_milliseconds && this->impl->_sequence == o.impl->_sequence )
         {
             return true;
         }
@@ -340,6 +353,11 @@ namespace ULog
         return this->impl->_milliseconds;
     }
     
+    uint64_t Message::GetSequence( void ) const
+    {
+        return this->impl->_sequence;
+    }
+    
     std::string Message::GetSourceString( void ) const
     {
         switch( this->impl->_source )
@@ -399,6 +417,11 @@ namespace ULog
         return this->impl->_message;
     }
     
+    const std::string & Message::GetText( void ) const
+    {
+        return this->impl->_message;
+    }
+    
     std::string Message::GetDescription( void ) const
     {
         std::string description;
@@ -417,6 +440,51 @@ namespace ULog
         return description;
     }
     
+    std::vector< Message::Field > Message::GetFields( void ) const
+    {
+        return this->impl->_fields;
+    }
+    
+    void Message::AddField( const std::string & key, const std::string & value )
+    {
+        this->impl->_fields.push_back( Field( key, value ) );
+    }
+    
+    void Message::SetSequence( uint64_t sequence )
+    {
+        this->impl->_sequence = sequence;
+    }
+    
+    const CallSite * Message::GetCallSite( void ) const
+    {
+        return this->impl->_site;
+    }
+    
+    void Message::SetCallSite( const CallSite * site )
+    {
+        this->impl->_site = site;
+    }
+    
+    const Context & Message::GetContext( void ) const
+    {
+        return this->impl->_context;
+    }
+    
+    void Message::SetContext( const Context & context )
+    {
+        this->impl->_context = context;
+    }
+    
+    const char * Message::GetCategory( void ) const
+    {
+        return this->impl->_category;
+    }
+    
+    void Message::SetCategory( const char * name )
+    {
+        this->impl->_category = name;
+    }
+    
     Message::IMPL::IMPL( void ):
         _source( SourceCXX ),
         _level( LevelDebug ),
@@ -424,7 +492,11 @@ namespace ULog
         _time( 0 ),
         _milliseconds( 0 ),
         _pid( 0 ),
-        _tid( 0 )
+        _tid( 0 ),
+        _sequence( 0 ),
+        _site( nullptr ),
+        _context( Context::GetCurrent() ),
+        _category( nullptr )
     {
         this->SetTimeToCurrent();
         this->SetProcessToCurrent();
@@ -440,7 +512,11 @@ namespace ULog
         _time( 0 ),
         _milliseconds( 0 ),
         _pid( 0 ),
-        _tid( 0 )
+        _tid( 0 ),
+        _sequence( 0 ),
+        _site( nullptr ),
+        _context( Context::GetCurrent() ),
+        _category( nullptr )
     {
         this->SetTimeToCurrent();
         this->SetProcessToCurrent();
@@ -457,7 +533,12 @@ namespace ULog
         _time( o._time ),
         _milliseconds( o._milliseconds ),
         _pid( o._pid ),
-        _tid( o._tid )
+        _tid( o._tid ),
+        _sequence( o._sequence ),
+        _fields( o._fields ),
+        _site( o._site ),
+        _context( o._context ),
+        _category( o._category )
     {}
     
     Message::IMPL::~IMPL( void )
@@ -509,18 +590,29 @@ namespace ULog
     }
     
     void Message::IMPL::SetThreadToCurrent( void )
+    {
+        this->_tid = Category::GetCurrentThreadID();
+    }
+    
+    uint64_t Message::IMPL::GetCurrentThreadID( void )
     {
         #if defined( _WIN32 )
         
-        this->_tid = static_cast< uint64_t >( GetCurrentThreadId() );
+        return static_cast< uint64_t >( GetCurrentThreadId() );
 
         #elif defined( __APPLE__ )
         
-        this->_tid = static_cast< uint64_t >( pthread_threadid_np( pthread_self(), NULL ) );
+        uint64_t tid;
+        
+        tid = 0;
+        
+        pthread_threadid_np( NULL, &tid );
+        
+        return tid;
         
         #else
         
-        this->_tid = static_cast< uint64_t >( syscall( SYS_gettid ) );
+        return static_cast< uint64_t >( syscall( SYS_gettid ) );
         
         #endif
     }
@@ -585,13 +677,13 @@ namespace ULog
         #else
         
         {
-            time_t      t;
-            struct tm * now;
+            time_t    t;
+            struct tm now;
             
-            t   = static_cast< time_t >( time );
-            now = localtime( &t );
+            t = static_cast< time_t >( time );
             
-            strftime( static_cast< char * >( dbuf ), sizeof( dbuf ), "%Y-%m-%d %H:%M:%S", now );
+            localtime_r( &t, &now );
+            strftime( static_cast< char * >( dbuf ), sizeof( dbuf ), "%Y-%m-%d %H:%M:%S", &now );
         }
         
         #endif
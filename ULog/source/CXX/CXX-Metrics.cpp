@@ -0,0 +1,354 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+/*!
+ * @file        CXX-Metrics.cpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#include <ULog/ULog.h>
+#include <ULog/CXX/Metrics.hpp>
+#include <atomic>
+
+namespace ULog
+{
+    namespace
+    {
+        const size_t CacheLineSize = 64;
+        const size_t StageCount    = Metrics::StageWritten + 1;
+        const size_t SinkCount     = Metrics::SinkFiles    + 1;
+        const size_t LevelCount    = Message::LevelDebug   + 1;
+        const size_t LatencyCount  = 40;
+        
+        typedef struct
+        {
+            std::atomic< uint64_t > value;
+            char                    padding[ CacheLineSize - sizeof( std::atomic< uint64_t > ) ];
+        }
+        Counter;
+        
+        /* Written by one thread at a time (under the logger lock), so a sink only needs its own lines */
+        typedef struct
+        {
+            std::atomic< uint64_t > bytes;
+            std::atomic< uint64_t > writes;
+            std::atomic< uint64_t > time;
+            std::atomic< uint64_t > latencies[ LatencyCount ];
+            char                    padding[ CacheLineSize ];
+        }
+        SinkCounters;
+        
+        void Copy( Counter & to, const Counter & from )
+        {
+            to.value.store( from.value.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+        }
+        
+        void Copy( std::atomic< uint64_t > & to, const std::atomic< uint64_t > & from )
+        {
+            to.store( from.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+        }
+    }
+    
+    class Metrics::IMPL
+    {
+        public:
+            
+            IMPL( void );
+            IMPL( const IMPL & o );
+            
+            ~IMPL( void );
+            
+            Counter      _messages[ StageCount ][ LevelCount ];
+            SinkCounters _sinks[ SinkCount ];
+            Counter      _queueDepth;
+            Counter      _queueHighWaterMark;
+            Counter      _lockWaits;
+            Counter      _lockWaitTime;
+    };
+    
+    Metrics::Metrics( void ): impl( new IMPL )
+    {}
+    
+    Metrics::Metrics( const Metrics & o ): impl( new IMPL( *( o.impl ) ) )
+    {}
+    
+    Metrics::Metrics( Metrics && o ): impl( o.impl )
+    {
+        o.impl = nullptr;
+    }
+    
+    Metrics::~Metrics( void )
+    {
+        delete this->impl;
+    }
+    
+    Metrics & Metrics::operator =( Metrics o )
+    {
+        swap( *( this ), o );
+        
+        return *( this );
+    }
+    
+    void swap( Metrics & o1, Metrics & o2 )
+    {
+        using std::swap;
+        
+        swap( o1.impl, o2.impl );
+    }
+    
+    void Metrics::AddMessage( Stage stage, Message::Level level )
+    {
+        if( static_cast< size_t >( stage ) >= StageCount || static_cast< size_t >( level ) >= LevelCount )
+        {
+            return;
+        }
+        
+        this->impl->_messages[ stage ][ level ].value.fetch_add( 1, std::memory_order_relaxed );
+    }
+    
+    void Metrics::AddWrite( Sink sink, uint64_t bytes, uint64_t nanoseconds )
+    {
+        size_t bucket;
+        
+        if( static_cast< size_t >( sink ) >= SinkCount )
+        {
+            return;
+        }
+        
+        for( bucket = 0; bucket + 1 < LatencyCount && ( nanoseconds >> ( bucket + 1 ) ) > 0; bucket++ )
+        {}
+        
+        this->impl->_sinks[ sink ].bytes.fetch_add( bytes, std::memory_order_relaxed );
+        this->impl->_sinks[ sink ].writes.fetch_add( 1, std::memory_order_relaxed );
+        this->impl->_sinks[ sink ].time.fetch_add( nanoseconds, std::memory_order_relaxed );
+        this->impl->_sinks[ sink ].latencies[ bucket ].fetch_add( 1, std::memory_order_relaxed );
+    }
+    
+    void Metrics::AddLockWait( uint64_t nanoseconds )
+    {
+        this->impl->_lockWaits.value.fetch_add( 1, std::memory_order_relaxed );
+        this->impl->_lockWaitTime.value.fetch_add( nanoseconds, std::memory_order_relaxed );
+    }
+    
+    void Metrics::SetQueueDepth( uint64_t depth )
+    {
+        uint64_t high;
+        
+        this->impl->_queueDepth.value.store( depth, std::memory_order_relaxed );
+        
+        high = this->impl->_queueHighWaterMark.value.load( std::memory_order_relaxed );
+        
+        while( depth > high && this->impl->_queueHighWaterMark.value.compare_exchange_weak( high, depth, std::memory_order_relaxed ) == false )
+        {}
+    }
+    
+    uint64_t Metrics::GetMessages( Stage stage ) const
+    {
+        uint64_t n;
+        
+        n = 0;
+        
+        if( static_cast< size_t >( stage ) >= StageCount )
+        {
+            return 0;
+        }
+        
+        for( const auto & count: this->impl->_messages[ stage ] )
+        {
+            n += count.value.load( std::memory_order_relaxed );
+        }
+        
+        return n;
+    }
+    
+    uint64_t Metrics::GetMessages( Stage stage, Message::Level level ) const
+    {
+        if( static_cast< size_t >( stage ) >= StageCount || static_cast< size_t >( level ) >= LevelCount )
+        {
+            return 0;
+        }
+        
+        return this->impl->_messages[ stage ][ level ].value.load( std::memory_order_relaxed );
+    }
+    
+    uint64_t Metrics::GetBytes( Sink sink ) const
+    {
+        if( static_cast< size_t >( sink ) >= SinkCount )
+        {
+            return 0;
+        }
+        
+        return this->impl->_sinks[ sink ].bytes.load( std::memory_order_relaxed );
+    }
+    
+    uint64_t Metrics::GetWrites( Sink sink ) const
+    {
+        if( static_cast< size_t >( sink ) >= SinkCount )
+        {
+            return 0;
+        }
+        
+        return this->impl->_sinks[ sink ].writes.load( std::memory_order_relaxed );
+    }
+    
+    uint64_t Metrics::GetWriteTime( Sink sink ) const
+    {
+        if( static_cast< size_t >( sink ) >= SinkCount )
+        {
+            return 0;
+        }
+        
+        return this->impl->_sinks[ sink ].time.load( std::memory_order_relaxed );
+    }
+    
+    uint64_t Metrics::GetQueueDepth( void ) const
+    {
+        return this->impl->_queueDepth.value.load( std::memory_order_relaxed );
+    }
+    
+    uint64_t Metrics::GetQueueHighWaterMark( void ) const
+    {
+        return this->impl->_queueHighWaterMark.value.load( std::memory_order_relaxed );
+    }
+    
+    uint64_t Metrics::GetLockWaits( void ) const
+    {
+        return this->impl->_lockWaits.value.load( std::memory_order_relaxed );
+    }
+    
+    uint64_t Metrics::GetLockWaitTime( void ) const
+    {
+        return this->impl->_lockWaitTime.value.load( std::memory_order_relaxed );
+    }
+    
+    std::vector< uint64_t > Metrics::GetLatencies( Sink sink ) const
+    {
+        std::vector< uint64_t > counts;
+        
+        if( static_cast< size_t >( sink ) >= SinkCount )
+        {
+            return counts;
+        }
+        
+        for( const auto & count: this->impl->_sinks[ sink ].latencies )
+        {
+            counts.push_back( count.load( std::memory_order_relaxed ) );
+        }
+        
+        return counts;
+    }
+    
+    /* Upper bound of the bucket holding the percentile */
+    uint64_t Metrics::GetLatency( Sink sink, double percentile ) const
+    {
+        std::vector< uint64_t > counts;
+        uint64_t                total;
+        uint64_t                seen;
+        
+        counts = this->GetLatencies( sink );
+        total  = 0;
+        seen   = 0;
+        
+        for( uint64_t count: counts )
+        {
+            total += count;
+        }
+        
+        if( total == 0 )
+        {
+            return 0;
+        }
+        
+        for( size_t i = 0; i < counts.size(); i++ )
+        {
+            seen += counts[ i ];
+            
+            if( static_cast< double >( seen ) >= ( percentile / 100.0 ) * static_cast< double >( total ) )
+            {
+                return ( static_cast< uint64_t >( 1 ) << ( i + 1 ) ) - 1;
+            }
+        }
+        
+        return ( static_cast< uint64_t >( 1 ) << LatencyCount ) - 1;
+    }
+    
+    Metrics::IMPL::IMPL( void )
+    {
+        for( auto & counts: this->_messages )
+        {
+            for( auto & count: counts )
+            {
+                count.value.store( 0, std::memory_order_relaxed );
+            }
+        }
+        
+        for( auto & sink: this->_sinks )
+        {
+            sink.bytes.store( 0, std::memory_order_relaxed );
+            sink.writes.store( 0, std::memory_order_relaxed );
+            sink.time.store( 0, std::memory_order_relaxed );
+            
+            for( auto & count: sink.latencies )
+            {
+                count.store( 0, std::memory_order_relaxed );
+            }
+        }
+        
+        this->_queueDepth.value.store( 0, std::memory_order_relaxed );
+        this->_queueHighWaterMark.value.store( 0, std::memory_order_relaxed );
+        this->_lockWaits.value.store( 0, std::memory_order_relaxed );
+        this->_lockWaitTime.value.store( 0, std::memory_order_relaxed );
+    }
+    
+    /* Snapshots use relaxed loads only, like Statistics */
+    Metrics::IMPL::IMPL( const IMPL & o )
+    {
+        for( size_t i = 0; i < StageCount; i++ )
+        {
+            for( size_t j = 0; j < LevelCount; j++ )
+            {
+                Copy( this->_messages[ i ][ j ], o._messages[ i ][ j ] );
+            }
+        }
+        
+        for( size_t i = 0; i < SinkCount; i++ )
+        {
+            Copy( this->_sinks[ i ].bytes,  o._sinks[ i ].bytes );
+            Copy( this->_sinks[ i ].writes, o._sinks[ i ].writes );
+            Copy( this->_sinks[ i ].time,   o._sinks[ i ].time );
+            
+            for( size_t j = 0; j < LatencyCount; j++ )
+            {
+                Copy( this->_sinks[ i ].latencies[ j ], o._sinks[ i ].latencies[ j ] );
+            }
+        }
+        
+        Copy( this->_queueDepth,         o._queueDepth );
+        Copy( this->_queueHighWaterMark, o._queueHighWaterMark );
+        Copy( this->_lockWaits,          o._lockWaits );
+        Copy( this->_lockWaitTime,       o._lockWaitTime );
+    }
+    
+    Metrics::IMPL::~IMPL( void )
+    {}
+}
@@ -0,0 +1,623 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+/*!
+ * @file        CXX-MetricsServer.cpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#if defined( _WIN32 )
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment( lib, "Ws2_32.lib" )
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <poll.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#endif
+
+#include <ULog/ULog.h>
+#include <ULog/CXX/MetricsServer.hpp>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <cstring>
+#include <cstdio>
+
+namespace ULog
+{
+    namespace
+    {
+        #if defined( _WIN32 )
+        
+        typedef SOCKET Socket;
+        
+        const Socket InvalidSocket = INVALID_SOCKET;
+        
+        void CloseSocket( Socket s )
+        {
+            closesocket( s );
+        }
+        
+        /* Balances the WSAStartup() of Start( port ) */
+        void CleanupSockets( void )
+        {
+            WSACleanup();
+        }
+        
+        void SetSendTimeout( Socket s, int milliseconds )
+        {
+            DWORD timeout;
+            
+            timeout = static_cast< DWORD >( milliseconds );
+            
+            setsockopt( s, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast< const char * >( &timeout ), sizeof( timeout ) );
+        }
+        
+        #else
+        
+        typedef int Socket;
+        
+        const Socket InvalidSocket = -1;
+        
+        void CloseSocket( Socket s )
+        {
+            close( s );
+        }
+        
+        void CleanupSockets( void )
+        {}
+        
+        void SetSendTimeout( Socket s, int milliseconds )
+        {
+            struct timeval timeout;
+            
+            timeout.tv_sec  = milliseconds / 1000;
+            timeout.tv_usec = ( milliseconds % 1000 ) * 1000;
+            
+            setsockopt( s, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof( timeout ) );
+        }
+        
+        #endif
+        
+        const char * LevelNames[]  = { "emergency", "alert", "critical", "error", "warning", "notice", "info", "debug" };
+        const char * SourceNames[] = { "c", "cxx", "objc", "objcxx", "asl", "cs" };
+        const char * DropNames[]   = { "sampled", "rate_limited", "newest", "oldest", "below_level", "timeout", "discarded" };
+        const char * StageNames[]  = { "accepted", "filtered", "dropped", "written" };
+        const char * SinkNames[]   = { "console", "files" };
+        
+        /* poll() rather than select(), which can't take descriptors past FD_SETSIZE */
+        bool WaitForData( Socket s, int milliseconds )
+        {
+            #if defined( _WIN32 )
+            
+            WSAPOLLFD fd;
+            
+            fd.fd      = s;
+            fd.events  = POLLRDNORM;
+            fd.revents = 0;
+            
+            return WSAPoll( &fd, 1, milliseconds ) > 0;
+            
+            #else
+            
+            struct pollfd fd;
+            
+            fd.fd      = s;
+            fd.events  = POLLIN;
+            fd.revents = 0;
+            
+            return poll( &fd, 1, milliseconds ) > 0;
+            
+            #endif
+        }
+        
+        void Append( std::string & s, const char * name, const std::string & labels, double value )
+        {
+            char buf[ 64 ];
+            
+            snprintf( buf, sizeof( buf ), " %.17g\n", value );
+            
+            s += name;
+            
+            if( labels.length() > 0 )
+            {
+                s += "{" + labels + "}";
+            }
+            
+            s += buf;
+        }
+        
+        void Append( std::string & s, const char * name, const std::string & labels, uint64_t value )
+        {
+            s += name;
+            
+            if( labels.length() > 0 )
+            {
+                s += "{" + labels + "}";
+            }
+            
+            s += " " + std::to_string( value ) + "\n";
+        }
+        
+        void AppendHeader( std::string & s, const char * name, const char * type, const char * help )
+        {
+            s += std::string( "# HELP " ) + name + " " + help + "\n";
+            s += std::string( "# TYPE " ) + name + " " + type + "\n";
+        }
+    }
+    
+    class MetricsServer::IMPL
+    {
+        public:
+            
+            IMPL( const Logger & logger );
+            
+            ~IMPL( void );
+            
+            const Logger      & _logger;
+            mutable std::mutex  _mtx;
+            Socket              _socket;
+            std::thread         _thread;
+            std::atomic< bool > _stop;
+            uint16_t            _port;
+            std::string         _path;
+            
+            bool Listen( Socket s );
+            void Run( void );
+            void Serve( Socket client );
+            
+            std::string GetText( void ) const;
+    };
+    
+    MetricsServer::MetricsServer( const Logger & logger ): impl( new IMPL( logger ) )
+    {}
+    
+    MetricsServer::~MetricsServer( void )
+    {
+        this->Stop();
+        
+        delete this->impl;
+    }
+    
+    bool MetricsServer::Start( uint16_t port )
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        struct sockaddr_in            addr;
+        socklen_t                     length;
+        Socket                        s;
+        int                           yes;
+        
+        if( this->impl->_socket != InvalidSocket )
+        {
+            return false;
+        }
+        
+        #if defined( _WIN32 )
+        
+        {
+            WSADATA data;
+            
+            if( WSAStartup( MAKEWORD( 2, 2 ), &data ) != 0 )
+            {
+                return false;
+            }
+        }
+        
+        #endif
+        
+        s = socket( AF_INET, SOCK_STREAM, 0 );
+        
+        if( s == InvalidSocket )
+        {
+            CleanupSockets();
+            
+            return false;
+        }
+        
+        yes = 1;
+        
+        setsockopt( s, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast< const char * >( &yes ), sizeof( yes ) );
+        memset( &addr, 0, sizeof( addr ) );
+        
+        addr.sin_family      = AF_INET;
+        addr.sin_port        = htons( port );
+        addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+        length               = sizeof( addr );
+        
+        if
+        (
+               bind( s, reinterpret_cast< struct sockaddr * >( &addr ), sizeof( addr ) ) != 0
+            || getsockname( s, reinterpret_cast< struct sockaddr * >( &addr ), &length ) != 0
+        )
+        {
+            CloseSocket( s );
+            CleanupSockets();
+            
+            return false;
+        }
+        
+        this->impl->_port = ntohs( addr.sin_port );
+        
+        if( this->impl->Listen( s ) == false )
+        {
+            CleanupSockets();
+            
+            return false;
+        }
+        
+        return true;
+    }
+    
+    bool MetricsServer::Start( const std::string & path )
+    {
+        #if defined( _WIN32 )
+        
+        ( void )path;
+        
+        return false;
+        
+        #else
+        
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        struct sockaddr_un            addr;
+        Socket                        s;
+        
+        if( this->impl->_socket != InvalidSocket || path.length() == 0 || path.length() >= sizeof( addr.sun_path ) )
+        {
+            return false;
+        }
+        
+        s = socket( AF_UNIX, SOCK_STREAM, 0 );
+        
+        if( s == InvalidSocket )
+        {
+            return false;
+        }
+        
+        memset( &addr, 0, sizeof( addr ) );
+        
+        addr.sun_family = AF_UNIX;
+        
+        memcpy( addr.sun_path, path.c_str(), path.length() );
+        
+        /* A stale socket from a previous run would make bind fail */
+        unlink( path.c_str() );
+        
+        if( bind( s, reinterpret_cast< struct sockaddr * >( &addr ), sizeof( addr ) ) != 0 )
+        {
+            CloseSocket( s );
+            
+            return false;
+        }
+        
+        this->impl->_path = path;
+        
+        return this->impl->Listen( s );
+        
+        #endif
+    }
+    
+    void MetricsServer::Stop( void )
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        if( this->impl->_socket == InvalidSocket )
+        {
+            return;
+        }
+        
+        this->impl->_stop = true;
+        
+        this->impl->_thread.join();
+        
+        CloseSocket( this->impl->_socket );
+        
+        #if defined( _WIN32 )
+        
+        CleanupSockets();
+        
+        #else
+        
+        if( this->impl->_path.length() > 0 )
+        {
+            unlink( this->impl->_path.c_str() );
+        }
+        
+        #endif
+        
+        this->impl->_socket = InvalidSocket;
+        this->impl->_port   = 0;
+        
+        this->impl->_path.clear();
+    }
+    
+    bool MetricsServer::IsRunning( void ) const
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        return this->impl->_socket != InvalidSocket;
+    }
+    
+    uint16_t MetricsServer::GetPort( void ) const
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        return this->impl->_port;
+    }
+    
+    std::string MetricsServer::GetText( void ) const
+    {
+        return this->impl->GetText();
+    }
+    
+    MetricsServer::IMPL::IMPL( const Logger & logger ):
+        _logger( logger ),
+        _socket( InvalidSocket ),
+        _stop( false ),
+        _port( 0 )
+    {}
+    
+    MetricsServer::IMPL::~IMPL( void )
+    {}
+    
+    /*
+     * Both snapshots are copies of relaxed atomics: building the page never
+     * takes the logger lock, so scrapes don't slow down logging.
+     */
+    std::string MetricsServer::IMPL::GetText( void ) const
+    {
+        Statistics  statistics( this->_logger.GetStatistics() );
+        Metrics     metrics( this->_logger.GetMetrics() );
+        std::string s;
+        
+        AppendHeader( s, "ulog_messages_total", "counter", "Messages logged, by level." );
+        
+        for( size_t i = 0; i < sizeof( LevelNames ) / sizeof( LevelNames[ 0 ] ); i++ )
+        {
+            Append( s, "ulog_messages_total", std::string( "level=\"" ) + LevelNames[ i ] + "\"", statistics.GetCount( static_cast< Message::Level >( i ) ) );
+        }
+        
+        AppendHeader( s, "ulog_messages_by_source_total", "counter", "Messages logged, by source." );
+        
+        for( size_t i = 0; i < sizeof( SourceNames ) / sizeof( SourceNames[ 0 ] ); i++ )
+        {
+            Append( s, "ulog_messages_by_source_total", std::string( "source=\"" ) + SourceNames[ i ] + "\"", statistics.GetCount( static_cast< Message::Source >( i ) ) );
+        }
+        
+        AppendHeader( s, "ulog_messages_per_second", "gauge", "Average rate over the last minute, by level." );
+        
+        for( size_t i = 0; i < sizeof( LevelNames ) / sizeof( LevelNames[ 0 ] ); i++ )
+        {
+            Append( s, "ulog_messages_per_second", std::string( "level=\"" ) + LevelNames[ i ] + "\"", statistics.GetRatePerSecond( static_cast< uint64_t >( 1 ) << i ) );
+        }
+        
+        AppendHeader( s, "ulog_stage_messages_total", "counter", "Messages accepted, filtered, dropped and written, by level." );
+        
+        for( size_t i = 0; i < sizeof( StageNames ) / sizeof( StageNames[ 0 ] ); i++ )
+        {
+            for( size_t j = 0; j < sizeof( LevelNames ) / sizeof( LevelNames[ 0 ] ); j++ )
+            {
+                Append( s, "ulog_stage_messages_total", std::string( "stage=\"" ) + StageNames[ i ] + "\",level=\"" + LevelNames[ j ] + "\"", metrics.GetMessages( static_cast< Metrics::Stage >( i ), static_cast< Message::Level >( j ) ) );
+            }
+        }
+        
+        AppendHeader( s, "ulog_dropped_total", "counter", "Messages dropped, by reason." );
+        
+        for( size_t i = 0; i < sizeof( DropNames ) / sizeof( DropNames[ 0 ] ); i++ )
+        {
+            Append( s, "ulog_dropped_total", std::string( "reason=\"" ) + DropNames[ i ] + "\"", statistics.GetDrops( static_cast< Statistics::Drop >( i ) ) );
+        }
+        
+        AppendHeader( s, "ulog_queue_depth", "gauge", "Messages waiting in the asynchronous queue." );
+        Append( s, "ulog_queue_depth", "", metrics.GetQueueDepth() );
+        AppendHeader( s, "ulog_queue_high_water_mark", "gauge", "Deepest the asynchronous queue has been." );
+        Append( s, "ulog_queue_high_water_mark", "", metrics.GetQueueHighWaterMark() );
+        AppendHeader( s, "ulog_lock_waits_total", "counter", "Contended lock acquisitions." );
+        Append( s, "ulog_lock_waits_total", "", metrics.GetLockWaits() );
+        AppendHeader( s, "ulog_lock_wait_seconds_total", "counter", "Time spent waiting for contended locks." );
+        Append( s, "ulog_lock_wait_seconds_total", "", static_cast< double >( metrics.GetLockWaitTime() ) / 1e9 );
+        AppendHeader( s, "ulog_sink_bytes_total", "counter", "Bytes written, by sink (all log files are one sink)." );
+        
+        for( size_t i = 0; i < sizeof( SinkNames ) / sizeof( SinkNames[ 0 ] ); i++ )
+        {
+            Append( s, "ulog_sink_bytes_total", std::string( "sink=\"" ) + SinkNames[ i ] + "\"", metrics.GetBytes( static_cast< Metrics::Sink >( i ) ) );
+        }
+        
+        AppendHeader( s, "ulog_sink_write_seconds", "histogram", "Write latency, by sink (all log files are one sink)." );
+        
+        for( size_t i = 0; i < sizeof( SinkNames ) / sizeof( SinkNames[ 0 ] ); i++ )
+        {
+            std::vector< uint64_t > latencies( metrics.GetLatencies( static_cast< Metrics::Sink >( i ) ) );
+            std::string             sink( std::string( "sink=\"" ) + SinkNames[ i ] + "\"" );
+            uint64_t                n;
+            char                    le[ 64 ];
+            
+            n = 0;
+            
+            for( size_t j = 0; j < latencies.size(); j++ )
+            {
+                n += latencies[ j ];
+                
+                snprintf( le, sizeof( le ), "%.9g", static_cast< double >( static_cast< uint64_t >( 1 ) << ( j + 1 ) ) / 1e9 );
+                Append( s, "ulog_sink_write_seconds_bucket", sink + ",le=\"" + le + "\"", n );
+            }
+            
+            Append( s, "ulog_sink_write_seconds_bucket", sink + ",le=\"+Inf\"", n );
+            Append( s, "ulog_sink_write_seconds_sum", sink, static_cast< double >( metrics.GetWriteTime( static_cast< Metrics::Sink >( i ) ) ) / 1e9 );
+            Append( s, "ulog_sink_write_seconds_count", sink, metrics.GetWrites( static_cast< Metrics::Sink >( i ) ) );
+        }
+        
+        return s;
+    }
+    
+    bool MetricsServer::IMPL::Listen( Socket s )
+    {
+        if( listen( s, 16 ) != 0 )
+        {
+            CloseSocket( s );
+            
+            this->_port = 0;
+            
+            this->_path.clear();
+            
+            return false;
+        }
+        
+        this->_socket = s;
+        this->_stop   = false;
+        this->_thread = std::thread( &IMPL::Run, this );
+        
+        return true;
+    }
+    
+    /* Polls so Stop() is noticed without closing the socket under accept */
+    void MetricsServer::IMPL::Run( void )
+    {
+        while( this->_stop == false )
+        {
+            Socket client;
+            
+            if( WaitForData( this->_socket, 200 ) == false )
+            {
+                continue;
+            }
+            
+            client = accept( this->_socket, nullptr, nullptr );
+            
+            if( client == InvalidSocket )
+            {
+                continue;
+            }
+            
+            this->Serve( client );
+            
+            CloseSocket( client );
+        }
+    }
+    
+    /*
+     * Clients are served one at a time, so each gets at most a second to send
+     * its request, and another to read the response: a slow one can't hold
+     * the others back for longer.
+     */
+    void MetricsServer::IMPL::Serve( Socket client )
+    {
+        std::chrono::steady_clock::time_point deadline;
+        std::string                           request;
+        std::string                           response;
+        std::string                           body;
+        std::string                           path;
+        size_t                                sent;
+        int                                   flags;
+        char                                  buf[ 1024 ];
+        
+        flags    = 0;
+        deadline = std::chrono::steady_clock::now() + std::chrono::seconds( 1 );
+        
+        #if defined( MSG_NOSIGNAL )
+        
+        flags = MSG_NOSIGNAL;
+        
+        #elif defined( SO_NOSIGPIPE )
+        
+        {
+            int yes = 1;
+            
+            setsockopt( client, SOL_SOCKET, SO_NOSIGPIPE, &yes, sizeof( yes ) );
+        }
+        
+        #endif
+        
+        while( request.find( "\r\n\r\n" ) == std::string::npos && request.length() < 8192 )
+        {
+            int n;
+            int remaining;
+            
+            remaining = static_cast< int >( std::chrono::duration_cast< std::chrono::milliseconds >( deadline - std::chrono::steady_clock::now() ).count() );
+            
+            if( remaining <= 0 || WaitForData( client, remaining ) == false )
+            {
+                return;
+            }
+            
+            n = static_cast< int >( recv( client, buf, sizeof( buf ), 0 ) );
+            
+            if( n <= 0 )
+            {
+                return;
+            }
+            
+            request.append( buf, static_cast< size_t >( n ) );
+        }
+        
+        if( request.compare( 0, 4, "GET " ) == 0 )
+        {
+            path = request.substr( 4, request.find( ' ', 4 ) - 4 );
+        }
+        
+        if( path == "/metrics" || path == "/" )
+        {
+            body     = this->GetText();
+            response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n";
+        }
+        else
+        {
+            body     = "Not Found\n";
+            response = "HTTP/1.0 404 Not Found\r\nContent-Type: text/plain\r\n";
+        }
+        
+        response += "Content-Length: " + std::to_string( body.length() ) + "\r\nConnection: close\r\n\r\n" + body;
+        deadline  = std::chrono::steady_clock::now() + std::chrono::seconds( 1 );
+        
+        for( sent = 0; sent < response.length(); )
+        {
+            int n;
+            int remaining;
+            
+            remaining = static_cast< int >( std::chrono::duration_cast< std::chrono::milliseconds >( deadline - std::chrono::steady_clock::now() ).count() );
+            
+            if( remaining <= 0 )
+            {
+                return;
+            }
+            
+            SetSendTimeout( client, remaining );
+            
+            n = static_cast< int >( send( client, response.c_str() + sent, static_cast< int >( response.length() - sent ), flags ) );
+            
+            if( n <= 0 )
+            {
+                return;
+            }
+            
+            sent += static_cast< size_t >( n );
+        }
+    }
+}
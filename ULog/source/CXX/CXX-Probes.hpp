@@ -0,0 +1,69 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+/*!
+ * @header      CXX-Probes.hpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#ifndef ULOG_CXX_PROBES_H
+#define ULOG_CXX_PROBES_H
+
+/*
+ * USDT static tracepoints, in the "ulog" provider. With sys/sdt.h (Linux,
+ * systemtap-sdt-dev), each probe is a single NOP until a tracer attaches:
+ * 
+ *     bpftrace -e 'usdt:./libulog.so:ulog:message_write { @[ arg0 ] = hist( arg2 ); }'
+ * 
+ * message_create   ( level, source, length )
+ * message_enqueue  ( level, depth )
+ * message_drop     ( level, reason )           Statistics::Drop
+ * message_filter   ( level )
+ * message_write    ( level, sequence, length )
+ * sink_write       ( sink, bytes, nanoseconds ) Metrics::Sink
+ * 
+ * Define ULOG_DISABLE_PROBES to compile them out.
+ */
+
+#if !defined( ULOG_DISABLE_PROBES ) && defined( __linux__ ) && defined( __has_include )
+#if __has_include( <sys/sdt.h> )
+#include <sys/sdt.h>
+#define ULOG_HAS_PROBES 1
+#endif
+#endif
+
+#ifdef ULOG_HAS_PROBES
+
+#define ULOG_PROBE1( name, a )          DTRACE_PROBE1( ulog, name, a )
+#define ULOG_PROBE2( name, a, b )       DTRACE_PROBE2( ulog, name, a, b )
+#define ULOG_PROBE3( name, a, b, c )    DTRACE_PROBE3( ulog, name, a, b, c )
+
+#else
+
+#define ULOG_PROBE1( name, a )          
+#define ULOG_PROBE2( name, a, b )       
+#define ULOG_PROBE3( name, a, b, c )    
+
+#endif
+
+#endif /* ULOG_CXX_PROBES_H */
@@ -0,0 +1,263 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+/*!
+ * @file        CXX-RequestContext.cpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#include <ULog/ULog.h>
+#include <ULog/CXX/RequestContext.hpp>
+#include <mutex>
+#include <deque>
+
+#if defined( _WIN32 ) && defined( GetMessage )
+#undef GetMessage
+#endif
+
+namespace ULog
+{
+    namespace
+    {
+        const size_t DefaultCapacity = 256;
+        
+        thread_local RequestContext * CurrentContext = nullptr;
+    }
+    
+    class RequestContext::IMPL
+    {
+        public:
+            
+            IMPL( Logger & logger );
+            
+            ~IMPL( void );
+            
+            mutable std::mutex            _mtx;
+                    Logger              * _logger;
+                    Message::Level        _level;
+                    size_t                _capacity;
+                    std::deque< Message > _messages;
+                    bool                  _failed;
+                    bool                  _finished;
+            
+            void Discard( void );
+    };
+    
+    RequestContext::RequestContext( void ): impl( std::make_shared< IMPL >( *( Logger::SharedInstance() ) ) )
+    {}
+    
+    RequestContext::RequestContext( Logger & logger ): impl( std::make_shared< IMPL >( logger ) )
+    {}
+    
+    RequestContext::RequestContext( const RequestContext & o ): impl( o.impl )
+    {}
+    
+    RequestContext::RequestContext( RequestContext && o ): impl( std::move( o.impl ) )
+    {}
+    
+    RequestContext::~RequestContext( void )
+    {}
+    
+    RequestContext & RequestContext::operator =( RequestContext o )
+    {
+        swap( *( this ), o );
+        
+        return *( this );
+    }
+    
+    void swap( RequestContext & o1, RequestContext & o2 )
+    {
+        using std::swap;
+        
+        swap( o1.impl, o2.impl );
+    }
+    
+    RequestContext * RequestContext::GetCurrent( void )
+    {
+        return CurrentContext;
+    }
+    
+    void RequestContext::SetCurrent( RequestContext * context )
+    {
+        CurrentContext = context;
+    }
+    
+    Message::Level RequestContext::GetLevel( void ) const
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        return this->impl->_level;
+    }
+    
+    void RequestContext::SetLevel( Message::Level level )
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        this->impl->_level = level;
+    }
+    
+    size_t RequestContext::GetCapacity( void ) const
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        return this->impl->_capacity;
+    }
+    
+    void RequestContext::SetCapacity( size_t capacity )
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        this->impl->_capacity = capacity;
+        
+        while( this->impl->_messages.size() > capacity )
+        {
+            this->impl->_logger->Discard( this->impl->_messages.front() );
+            this->impl->_messages.pop_front();
+        }
+    }
+    
+    size_t RequestContext::GetCount( void ) const
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        return this->impl->_messages.size();
+    }
+    
+    bool RequestContext::IsFailed( void ) const
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        return this->impl->_failed;
+    }
+    
+    void RequestContext::MarkFailed( void )
+    {
+        std::deque< Message > messages;
+        
+        {
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            
+            if( this->impl->_failed || this->impl->_finished )
+            {
+                return;
+            }
+            
+            this->impl->_failed = true;
+            
+            swap( messages, this->impl->_messages );
+        }
+        
+        for( const auto & m: messages )
+        {
+            this->impl->_logger->Ingest( m );
+        }
+    }
+    
+    void RequestContext::Finish( void )
+    {
+        std::lock_guard< std::mutex > l( this->impl->_mtx );
+        
+        this->impl->_finished = true;
+        
+        this->impl->Discard();
+    }
+    
+    /*
+     * Once a request has failed its messages are no longer buffered, so the
+     * rest of it is logged as it happens.
+     */
+    bool RequestContext::Buffer( Logger & logger, const Message & msg )
+    {
+        std::deque< Message > messages;
+        
+        {
+            std::lock_guard< std::mutex > l( this->impl->_mtx );
+            
+            if( &logger != this->impl->_logger || this->impl->_failed || this->impl->_finished )
+            {
+                return false;
+            }
+            
+            if( msg.GetLevel() >= this->impl->_level )
+            {
+                if( this->impl->_capacity == 0 )
+                {
+                    logger.Discard( msg );
+                    
+                    return true;
+                }
+                
+                if( this->impl->_messages.size() == this->impl->_capacity )
+                {
+                    logger.Discard( this->impl->_messages.front() );
+                    this->impl->_messages.pop_front();
+                }
+                
+                this->impl->_messages.push_back( msg );
+                
+                return true;
+            }
+            
+            if( msg.GetLevel() > Message::LevelError )
+            {
+                return false;
+            }
+            
+            this->impl->_failed = true;
+            
+            swap( messages, this->impl->_messages );
+        }
+        
+        /* Written before the error that failed the request */
+        for( const auto & m: messages )
+        {
+            logger.Ingest( m );
+        }
+        
+        return false;
+    }
+    
+    RequestContext::IMPL::IMPL( Logger & logger ):
+        _logger( &logger ),
+        _level( Message::LevelInfo ),
+        _capacity( DefaultCapacity ),
+        _failed( false ),
+        _finished( false )
+    {}
+    
+    RequestContext::IMPL::~IMPL( void )
+    {
+        this->Discard();
+    }
+    
+    /* Buffered messages already went through admission, so they count as drops */
+    void RequestContext::IMPL::Discard( void )
+    {
+        for( const auto & m: this->_messages )
+        {
+            this->_logger->Discard( m );
+        }
+        
+        this->_messages.clear();
+    }
+}
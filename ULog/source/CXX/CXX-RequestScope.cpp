@@ -0,0 +1,65 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+/*!
+ * @file        CXX-RequestScope.cpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#include <ULog/ULog.h>
+#include <ULog/CXX/RequestScope.hpp>
+
+namespace ULog
+{
+    class RequestScope::IMPL
+    {
+        public:
+            
+            IMPL( const RequestContext & context );
+            
+            ~IMPL( void );
+            
+            RequestContext   _context;
+            RequestContext * _previous;
+    };
+    
+    RequestScope::RequestScope( const RequestContext & context ): impl( new IMPL( context ) )
+    {
+        RequestContext::SetCurrent( &( this->impl->_context ) );
+    }
+    
+    RequestScope::~RequestScope( void )
+    {
+        RequestContext::SetCurrent( this->impl->_previous );
+        
+        delete this->impl;
+    }
+    
+    RequestScope::IMPL::IMPL( const RequestContext & context ):
+        _context( context ),
+        _previous( RequestContext::GetCurrent() )
+    {}
+    
+    RequestScope::IMPL::~IMPL( void )
+    {}
+}
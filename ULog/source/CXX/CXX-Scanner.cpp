@@ -0,0 +1,358 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+/*!
+ * @file        CXX-Scanner.cpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#include <ULog/ULog.h>
+#include <ULog/CXX/Scanner.hpp>
+#include <cstdint>
+#include <cstring>
+
+#if defined( __AVX2__ )
+#define ULOG_SCANNER_AVX2   1
+#include <immintrin.h>
+#endif
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define ULOG_SCANNER_SSE2   1
+#include <emmintrin.h>
+#endif
+
+#if defined( __ARM_NEON ) && defined( __aarch64__ )
+#define ULOG_SCANNER_NEON   1
+#include <arm_neon.h>
+#endif
+
+#if defined( _MSC_VER ) && !defined( __clang__ )
+#include <intrin.h>
+#endif
+
+namespace ULog
+{
+    namespace
+    {
+        inline unsigned char Lower( unsigned char c )
+        {
+            return ( c >= 'A' && c <= 'Z' ) ? static_cast< unsigned char >( c + ( 'a' - 'A' ) ) : c;
+        }
+        
+        inline size_t CountTrailingZeros( uint64_t x )
+        {
+            #if defined( _MSC_VER ) && !defined( __clang__ )
+            
+            unsigned long i;
+            
+            if( _BitScanForward( &i, static_cast< unsigned long >( x ) ) )
+            {
+                return static_cast< size_t >( i );
+            }
+            
+            _BitScanForward( &i, static_cast< unsigned long >( x >> 32 ) );
+            
+            return static_cast< size_t >( i ) + 32;
+            
+            #else
+            
+            return static_cast< size_t >( __builtin_ctzll( x ) );
+            
+            #endif
+        }
+        
+        #if defined( ULOG_SCANNER_AVX2 )
+        
+        inline __m256i Lower( __m256i v )
+        {
+            __m256i upper;
+            
+            upper = _mm256_and_si256( _mm256_cmpgt_epi8( v, _mm256_set1_epi8( 'A' - 1 ) ), _mm256_cmpgt_epi8( _mm256_set1_epi8( 'Z' + 1 ), v ) );
+            
+            return _mm256_or_si256( v, _mm256_and_si256( upper, _mm256_set1_epi8( 0x20 ) ) );
+        }
+        
+        #endif
+        
+        #if defined( ULOG_SCANNER_SSE2 )
+        
+        /* Signed compares leave bytes >= 0x80 alone: only ASCII is folded */
+        inline __m128i Lower( __m128i v )
+        {
+            __m128i upper;
+            
+            upper = _mm_and_si128( _mm_cmpgt_epi8( v, _mm_set1_epi8( 'A' - 1 ) ), _mm_cmplt_epi8( v, _mm_set1_epi8( 'Z' + 1 ) ) );
+            
+            return _mm_or_si128( v, _mm_and_si128( upper, _mm_set1_epi8( 0x20 ) ) );
+        }
+        
+        #elif defined( ULOG_SCANNER_NEON )
+        
+        inline uint8x16_t Lower( uint8x16_t v )
+        {
+            uint8x16_t upper;
+            
+            upper = vandq_u8( vcgeq_u8( v, vdupq_n_u8( 'A' ) ), vcleq_u8( v, vdupq_n_u8( 'Z' ) ) );
+            
+            return vorrq_u8( v, vandq_u8( upper, vdupq_n_u8( 0x20 ) ) );
+        }
+        
+        /* One nibble per byte, as there is no movemask */
+        inline uint64_t Mask( uint8x16_t m )
+        {
+            return vget_lane_u64( vreinterpret_u64_u8( vshrn_n_u16( vreinterpretq_u16_u8( m ), 4 ) ), 0 );
+        }
+        
+        #endif
+        
+        bool Equal( const char * s1, const char * s2, size_t length, bool caseInsensitive )
+        {
+            size_t i;
+            
+            if( caseInsensitive == false )
+            {
+                return memcmp( s1, s2, length ) == 0;
+            }
+            
+            i = 0;
+            
+            #if defined( ULOG_SCANNER_SSE2 )
+            
+            for( ; i + 16 <= length; i += 16 )
+            {
+                __m128i v1;
+                __m128i v2;
+                
+                v1 = Lower( _mm_loadu_si128( reinterpret_cast< const __m128i * >( s1 + i ) ) );
+                v2 = Lower( _mm_loadu_si128( reinterpret_cast< const __m128i * >( s2 + i ) ) );
+                
+                if( _mm_movemask_epi8( _mm_cmpeq_epi8( v1, v2 ) ) != 0xFFFF )
+                {
+                    return false;
+                }
+            }
+            
+            #elif defined( ULOG_SCANNER_NEON )
+            
+            for( ; i + 16 <= length; i += 16 )
+            {
+                uint8x16_t v1;
+                uint8x16_t v2;
+                
+                v1 = Lower( vld1q_u8( reinterpret_cast< const uint8_t * >( s1 + i ) ) );
+                v2 = Lower( vld1q_u8( reinterpret_cast< const uint8_t * >( s2 + i ) ) );
+                
+                if( vminvq_u8( vceqq_u8( v1, v2 ) ) == 0 )
+                {
+                    return false;
+                }
+            }
+            
+            #endif
+            
+            for( ; i < length; i++ )
+            {
+                if( Lower( static_cast< unsigned char >( s1[ i ] ) ) != Lower( static_cast< unsigned char >( s2[ i ] ) ) )
+                {
+                    return false;
+                }
+            }
+            
+            return true;
+        }
+    }
+    
+    const size_t Scanner::NotFound;
+    
+    /*
+     * Candidates are positions where both the first and the last byte of the
+     * query match, tested a whole register at a time; only those are
+     * verified.
+     */
+    size_t Scanner::Find( const char * s, size_t length, const char * query, size_t queryLength, bool caseInsensitive )
+    {
+        unsigned char first;
+        unsigned char last;
+        size_t        end;
+        size_t        i;
+        
+        if( queryLength == 0 )
+        {
+            return 0;
+        }
+        
+        if( queryLength > length )
+        {
+            return NotFound;
+        }
+        
+        first = static_cast< unsigned char >( query[ 0 ] );
+        last  = static_cast< unsigned char >( query[ queryLength - 1 ] );
+        
+        if( caseInsensitive )
+        {
+            first = Lower( first );
+            last  = Lower( last );
+        }
+        
+        /* Number of candidate positions */
+        end = length - queryLength + 1;
+        i   = 0;
+        
+        #if defined( ULOG_SCANNER_AVX2 )
+        
+        {
+            const __m256i f = _mm256_set1_epi8( static_cast< char >( first ) );
+            const __m256i l = _mm256_set1_epi8( static_cast< char >( last ) );
+            
+            for( ; i + 32 <= end; i += 32 )
+            {
+                __m256i  v1;
+                __m256i  v2;
+                uint64_t bits;
+                
+                v1 = _mm256_loadu_si256( reinterpret_cast< const __m256i * >( s + i ) );
+                v2 = _mm256_loadu_si256( reinterpret_cast< const __m256i * >( s + i + queryLength - 1 ) );
+                
+                if( caseInsensitive )
+                {
+                    v1 = Lower( v1 );
+                    v2 = Lower( v2 );
+                }
+                
+                bits = static_cast< uint32_t >( _mm256_movemask_epi8( _mm256_and_si256( _mm256_cmpeq_epi8( v1, f ), _mm256_cmpeq_epi8( v2, l ) ) ) );
+                
+                while( bits != 0 )
+                {
+                    size_t n;
+                    
+                    n = i + CountTrailingZeros( bits );
+                    
+                    if( Equal( s + n + 1, query + 1, queryLength - 1, caseInsensitive ) )
+                    {
+                        return n;
+                    }
+                    
+                    bits &= bits - 1;
+                }
+            }
+        }
+        
+        #endif
+        
+        #if defined( ULOG_SCANNER_SSE2 )
+        
+        {
+            const __m128i f = _mm_set1_epi8( static_cast< char >( first ) );
+            const __m128i l = _mm_set1_epi8( static_cast< char >( last ) );
+            
+            for( ; i + 16 <= end; i += 16 )
+            {
+                __m128i  v1;
+                __m128i  v2;
+                uint64_t bits;
+                
+                v1 = _mm_loadu_si128( reinterpret_cast< const __m128i * >( s + i ) );
+                v2 = _mm_loadu_si128( reinterpret_cast< const __m128i * >( s + i + queryLength - 1 ) );
+                
+                if( caseInsensitive )
+                {
+                    v1 = Lower( v1 );
+                    v2 = Lower( v2 );
+                }
+                
+                bits = static_cast< uint32_t >( _mm_movemask_epi8( _mm_and_si128( _mm_cmpeq_epi8( v1, f ), _mm_cmpeq_epi8( v2, l ) ) ) );
+                
+                while( bits != 0 )
+                {
+                    size_t n;
+                    
+                    n = i + CountTrailingZeros( bits );
+                    
+                    if( Equal( s + n + 1, query + 1, queryLength - 1, caseInsensitive ) )
+                    {
+                        return n;
+                    }
+                    
+                    bits &= bits - 1;
+                }
+            }
+        }
+        
+        #elif defined( ULOG_SCANNER_NEON )
+        
+        {
+            const uint8x16_t f = vdupq_n_u8( first );
+            const uint8x16_t l = vdupq_n_u8( last );
+            
+            for( ; i + 16 <= end; i += 16 )
+            {
+                uint8x16_t v1;
+                uint8x16_t v2;
+                uint64_t   bits;
+                
+                v1 = vld1q_u8( reinterpret_cast< const uint8_t * >( s + i ) );
+                v2 = vld1q_u8( reinterpret_cast< const uint8_t * >( s + i + queryLength - 1 ) );
+                
+                if( caseInsensitive )
+                {
+                    v1 = Lower( v1 );
+                    v2 = Lower( v2 );
+                }
+                
+                bits = Mask( vandq_u8( vceqq_u8( v1, f ), vceqq_u8( v2, l ) ) );
+                
+                while( bits != 0 )
+                {
+                    size_t n;
+                    
+                    n = i + ( CountTrailingZeros( bits ) >> 2 );
+                    
+                    if( Equal( s + n + 1, query + 1, queryLength - 1, caseInsensitive ) )
+                    {
+                        return n;
+                    }
+                    
+                    bits &= ~( static_cast< uint64_t >( 0xF ) << ( ( n - i ) << 2 ) );
+                }
+            }
+        }
+        
+        #endif
+        
+        for( ; i < end; i++ )
+        {
+            unsigned char c;
+            
+            c = static_cast< unsigned char >( s[ i ] );
+            
+            if( ( ( caseInsensitive ) ? Lower( c ) : c ) == first && Equal( s + i + 1, query + 1, queryLength - 1, caseInsensitive ) )
+            {
+                return i;
+            }
+        }
+        
+        return NotFound;
+    }
+}
@@ -0,0 +1,420 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+/*!
+ * @file        CXX-SearchIndex.cpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#include <ULog/ULog.h>
+#include <ULog/CXX/SearchIndex.hpp>
+#include <unordered_map>
+#include <deque>
+#include <algorithm>
+#include <limits>
+
+#if defined( _WIN32 ) && defined( GetMessage )
+#undef GetMessage
+#endif
+
+namespace ULog
+{
+    namespace
+    {
+        typedef struct
+        {
+            std::vector< uint32_t > ids;
+            size_t                  head;
+        }
+        Posting;
+        
+        const uint64_t NoDocument = std::numeric_limits< uint64_t >::max();
+        
+        inline unsigned char Lower( unsigned char c )
+        {
+            return ( c >= 'A' && c <= 'Z' ) ? static_cast< unsigned char >( c + ( 'a' - 'A' ) ) : c;
+        }
+        
+        /*
+         * Trigrams are ASCII case-folded, so a single index serves both case
+         * sensitive and insensitive queries; the caller verifies candidates.
+         */
+        std::vector< uint32_t > GetTrigrams( const std::string & s )
+        {
+            std::vector< uint32_t > trigrams;
+            const unsigned char   * p;
+            uint32_t                t;
+            size_t                  i;
+            
+            if( s.length() < SearchIndex::MinimumQueryLength )
+            {
+                return trigrams;
+            }
+            
+            p = reinterpret_cast< const unsigned char * >( s.data() );
+            t = ( static_cast< uint32_t >( Lower( p[ 0 ] ) ) << 8 ) | Lower( p[ 1 ] );
+            
+            trigrams.reserve( s.length() - 2 );
+            
+            for( i = 2; i < s.length(); i++ )
+            {
+                t = ( ( t << 8 ) | Lower( p[ i ] ) ) & 0xFFFFFF;
+                
+                trigrams.push_back( t );
+            }
+            
+            std::sort( trigrams.begin(), trigrams.end() );
+            trigrams.erase( std::unique( trigrams.begin(), trigrams.end() ), trigrams.end() );
+            
+            return trigrams;
+        }
+    }
+    
+    class SearchIndex::IMPL
+    {
+        public:
+            
+            IMPL( void );
+            IMPL( const IMPL & o );
+            
+            ~IMPL( void );
+            
+            std::unordered_map< uint32_t, Posting > _postings;
+            std::deque< uint64_t >                  _times;
+            uint64_t                                _base;
+            uint64_t                                _first;
+            size_t                                  _count;
+    };
+    
+    const size_t SearchIndex::MinimumQueryLength;
+    
+    SearchIndex::Key SearchIndex::GetKey( const Message & msg )
+    {
+        return Key( ( msg.GetTime() * 1000 ) + msg.GetMilliseconds(), msg.GetSequence() );
+    }
+    
+    SearchIndex::SearchIndex( void ): impl( new IMPL )
+    {}
+    
+    SearchIndex::SearchIndex( const SearchIndex & o ): impl( new IMPL( *( o.impl ) ) )
+    {}
+    
+    SearchIndex::SearchIndex( SearchIndex && o ): impl( o.impl )
+    {
+        o.impl = nullptr;
+    }
+    
+    SearchIndex::~SearchIndex( void )
+    {
+        delete this->impl;
+    }
+    
+    SearchIndex & SearchIndex::operator =( SearchIndex o )
+    {
+        swap( *( this ), o );
+        
+        return *( this );
+    }
+    
+    void swap( SearchIndex & o1, SearchIndex & o2 )
+    {
+        using std::swap;
+        
+        swap( o1.impl, o2.impl );
+    }
+    
+    bool SearchIndex::Add( const Message & msg )
+    {
+        uint64_t seq;
+        uint32_t id;
+        
+        seq = msg.GetSequence();
+        
+        if( this->impl->_count == 0 )
+        {
+            this->impl->_base  = seq;
+            this->impl->_first = 0;
+            
+            this->impl->_times.clear();
+        }
+        
+        /*
+         * A flight recorder dump brings back messages stamped before the
+         * base: ids are rebased in place, which keeps every posting sorted.
+         */
+        if( seq < this->impl->_base )
+        {
+            uint64_t shift;
+            
+            shift = this->impl->_base - seq;
+            
+            if( this->impl->_first + this->impl->_times.size() + shift > std::numeric_limits< uint32_t >::max() )
+            {
+                return false;
+            }
+            
+            for( auto & p: this->impl->_postings )
+            {
+                for( uint32_t & i: p.second.ids )
+                {
+                    i += static_cast< uint32_t >( shift );
+                }
+            }
+            
+            this->impl->_base   = seq;
+            this->impl->_first += shift;
+        }
+        
+        if( seq - this->impl->_base > std::numeric_limits< uint32_t >::max() )
+        {
+            return false;
+        }
+        
+        id = static_cast< uint32_t >( seq - this->impl->_base );
+        
+        while( id < this->impl->_first )
+        {
+            this->impl->_times.push_front( NoDocument );
+            
+            this->impl->_first--;
+        }
+        
+        while( id - this->impl->_first >= this->impl->_times.size() )
+        {
+            this->impl->_times.push_back( NoDocument );
+        }
+        
+        if( this->impl->_times[ id - this->impl->_first ] != NoDocument )
+        {
+            return true;
+        }
+        
+        this->impl->_times[ id - this->impl->_first ] = GetKey( msg ).first;
+        this->impl->_count++;
+        
+        for( uint32_t t: GetTrigrams( msg.GetText() ) )
+        {
+            std::vector< uint32_t > & ids = this->impl->_postings[ t ].ids;
+            
+            /* Messages are indexed as they are logged, so this is an append */
+            if( ids.size() == 0 || ids.back() < id )
+            {
+                ids.push_back( id );
+            }
+            else
+            {
+                ids.insert( std::lower_bound( ids.begin(), ids.end(), id ), id );
+            }
+        }
+        
+        return true;
+    }
+    
+    void SearchIndex::Remove( const Message & msg )
+    {
+        uint64_t seq;
+        uint32_t id;
+        
+        seq = msg.GetSequence();
+        
+        if( this->impl->_count == 0 || seq < this->impl->_base || seq - this->impl->_base > std::numeric_limits< uint32_t >::max() )
+        {
+            return;
+        }
+        
+        id = static_cast< uint32_t >( seq - this->impl->_base );
+        
+        if( id < this->impl->_first || id - this->impl->_first >= this->impl->_times.size() || this->impl->_times[ id - this->impl->_first ] == NoDocument )
+        {
+            return;
+        }
+        
+        for( uint32_t t: GetTrigrams( msg.GetText() ) )
+        {
+            std::unordered_map< uint32_t, Posting >::iterator it;
+            std::vector< uint32_t >::iterator                 pos;
+            
+            it = this->impl->_postings.find( t );
+            
+            if( it == this->impl->_postings.end() )
+            {
+                continue;
+            }
+            
+            Posting & p = it->second;
+            
+            /*
+             * History is evicted oldest first, so removal is almost always
+             * at the head; the consumed prefix is compacted lazily.
+             */
+            if( p.ids[ p.head ] == id )
+            {
+                p.head++;
+            }
+            else
+            {
+                pos = std::lower_bound( p.ids.begin() + static_cast< std::ptrdiff_t >( p.head ), p.ids.end(), id );
+                
+                if( pos != p.ids.end() && *( pos ) == id )
+                {
+                    p.ids.erase( pos );
+                }
+            }
+            
+            if( p.head == p.ids.size() )
+            {
+                this->impl->_postings.erase( it );
+            }
+            else if( p.head >= 64 && p.head * 2 >= p.ids.size() )
+            {
+                p.ids.erase( p.ids.begin(), p.ids.begin() + static_cast< std::ptrdiff_t >( p.head ) );
+                
+                p.head = 0;
+            }
+        }
+        
+        this->impl->_times[ id - this->impl->_first ] = NoDocument;
+        this->impl->_count--;
+        
+        while( this->impl->_times.size() > 0 && this->impl->_times.front() == NoDocument )
+        {
+            this->impl->_times.pop_front();
+            
+            this->impl->_first++;
+        }
+        
+        while( this->impl->_times.size() > 0 && this->impl->_times.back() == NoDocument )
+        {
+            this->impl->_times.pop_back();
+        }
+    }
+    
+    void SearchIndex::Clear( void )
+    {
+        this->impl->_postings.clear();
+        this->impl->_times.clear();
+        
+        this->impl->_base  = 0;
+        this->impl->_first = 0;
+        this->impl->_count = 0;
+    }
+    
+    size_t SearchIndex::GetCount( void ) const
+    {
+        return this->impl->_count;
+    }
+    
+    std::vector< SearchIndex::Key > SearchIndex::GetCandidates( const std::string & query ) const
+    {
+        std::vector< Key >             keys;
+        std::vector< const Posting * > postings;
+        std::vector< uint32_t >        ids;
+        
+        for( uint32_t t: GetTrigrams( query ) )
+        {
+            std::unordered_map< uint32_t, Posting >::const_iterator it;
+            
+            it = this->impl->_postings.find( t );
+            
+            if( it == this->impl->_postings.end() )
+            {
+                return keys;
+            }
+            
+            postings.push_back( &( it->second ) );
+        }
+        
+        if( postings.size() == 0 )
+        {
+            return keys;
+        }
+        
+        /* Smallest list first, so every step only narrows a short list */
+        std::sort
+        (
+            postings.begin(),
+            postings.end(),
+            []( const Posting * p1, const Posting * p2 ) -> bool
+            {
+                return p1->ids.size() - p1->head < p2->ids.size() - p2->head;
+            }
+        );
+        
+        ids.assign( postings[ 0 ]->ids.begin() + static_cast< std::ptrdiff_t >( postings[ 0 ]->head ), postings[ 0 ]->ids.end() );
+        
+        for( size_t i = 1; i < postings.size() && ids.size() > 0; i++ )
+        {
+            std::vector< uint32_t >::const_iterator pos;
+            std::vector< uint32_t >::const_iterator end;
+            size_t                                  n;
+            
+            pos = postings[ i ]->ids.begin() + static_cast< std::ptrdiff_t >( postings[ i ]->head );
+            end = postings[ i ]->ids.end();
+            n   = 0;
+            
+            for( uint32_t id: ids )
+            {
+                pos = std::lower_bound( pos, end, id );
+                
+                if( pos == end )
+                {
+                    break;
+                }
+                
+                if( *( pos ) == id )
+                {
+                    ids[ n++ ] = id;
+                }
+            }
+            
+            ids.resize( n );
+        }
+        
+        keys.reserve( ids.size() );
+        
+        for( uint32_t id: ids )
+        {
+            keys.push_back( Key( this->impl->_times[ id - this->impl->_first ], this->impl->_base + id ) );
+        }
+        
+        return keys;
+    }
+    
+    SearchIndex::IMPL::IMPL( void ):
+        _base( 0 ),
+        _first( 0 ),
+        _count( 0 )
+    {}
+    
+    SearchIndex::IMPL::IMPL( const IMPL & o ):
+        _postings( o._postings ),
+        _times( o._times ),
+        _base( o._base ),
+        _first( o._first ),
+        _count( o._count )
+    {}
+    
+    SearchIndex::IMPL::~IMPL( void )
+    {}
+}
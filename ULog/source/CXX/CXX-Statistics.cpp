@@ -0,0 +1,408 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www.xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+/*!
+ * @file        CXX-Statistics.cpp
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#include <ULog/ULog.h>
+#include <ULog/CXX/Statistics.hpp>
+#include <atomic>
+#include <thread>
+#include <limits>
+#include <ctime>
+
+namespace ULog
+{
+    namespace
+    {
+        const size_t   CacheLineSize = 64;
+        const size_t   LevelCount    = Message::LevelDebug + 1;
+        const size_t   SourceCount   = Message::SourceCS   + 1;
+        const size_t   DropCount     = Statistics::DropDiscarded + 1;
+        const uint64_t BucketCount   = 60;
+        const uint64_t Recycling     = std::numeric_limits< uint64_t >::max();
+        
+        /*
+         * Padded rather than aligned, as C++11 new ignores over-alignment:
+         * a full line per counter still keeps any two of them apart.
+         */
+        typedef struct
+        {
+            std::atomic< uint64_t > value;
+            char                    padding[ CacheLineSize - sizeof( std::atomic< uint64_t > ) ];
+        }
+        Counter;
+        
+        typedef struct
+        {
+            std::atomic< uint64_t > time;
+            std::atomic< uint64_t > levels[ LevelCount ];
+            char                    padding[ 2 * CacheLineSize - ( LevelCount + 1 ) * sizeof( std::atomic< uint64_t > ) ];
+        }
+        Bucket;
+        
+        /*
+         * The thread that wins the exchange to Recycling resets the counts;
+         * others wait for the new time, so no increment is lost to a reset.
+         */
+        void AddToBucket( Bucket & bucket, uint64_t time, size_t level )
+        {
+            uint64_t current;
+            
+            for( ;; )
+            {
+                current = bucket.time.load( std::memory_order_acquire );
+                
+                if( current == time )
+                {
+                    bucket.levels[ level ].fetch_add( 1, std::memory_order_relaxed );
+                    
+                    return;
+                }
+                
+                if( current == Recycling )
+                {
+                    std::this_thread::yield();
+                    
+                    continue;
+                }
+                
+                /* Late message, its bucket has already been recycled */
+                if( current > time )
+                {
+                    return;
+                }
+                
+                if( bucket.time.compare_exchange_weak( current, Recycling, std::memory_order_acquire, std::memory_order_relaxed ) )
+                {
+                    for( auto & count: bucket.levels )
+                    {
+                        count.store( 0, std::memory_order_relaxed );
+                    }
+                    
+                    bucket.time.store( time, std::memory_order_release );
+                }
+            }
+        }
+        
+        void CopyBucket( Bucket & to, const Bucket & from )
+        {
+            to.time.store( from.time.load( std::memory_order_acquire ), std::memory_order_relaxed );
+            
+            for( size_t level = 0; level < LevelCount; level++ )
+            {
+                to.levels[ level ].store( from.levels[ level ].load( std::memory_order_relaxed ), std::memory_order_relaxed );
+            }
+        }
+        
+        std::vector< uint64_t > GetBuckets( const Bucket * buckets, uint64_t now, uint64_t levelMask )
+        {
+            std::vector< uint64_t > counts( BucketCount, 0 );
+            
+            for( uint64_t i = 0; i < BucketCount && now + i + 1 >= BucketCount; i++ )
+            {
+                const Bucket & bucket = buckets[ ( now + i + 1 - BucketCount ) % BucketCount ];
+                
+                if( bucket.time.load( std::memory_order_acquire ) != now + i + 1 - BucketCount )
+                {
+                    continue;
+                }
+                
+                for( size_t level = 0; level < LevelCount; level++ )
+                {
+                    if( levelMask & ( static_cast< uint64_t >( 1 ) << level ) )
+                    {
+                        counts[ i ] += bucket.levels[ level ].load( std::memory_order_relaxed );
+                    }
+                }
+            }
+            
+            return counts;
+        }
+    }
+    
+    class Statistics::IMPL
+    {
+        public:
+            
+            IMPL( void );
+            IMPL( const IMPL & o );
+            
+            ~IMPL( void );
+            
+            Counter  _levels[ LevelCount ];
+            Counter  _sources[ SourceCount ];
+            Counter  _drops[ DropCount ][ LevelCount ];
+            Bucket   _seconds[ BucketCount ];
+            Bucket   _minutes[ BucketCount ];
+            uint64_t _time;
+    };
+    
+    Statistics::Statistics( void ): impl( new IMPL )
+    {}
+    
+    Statistics::Statistics( const Statistics & o ): impl( new IMPL( *( o.impl ) ) )
+    {}
+    
+    Statistics::Statistics( Statistics && o ): impl( o.impl )
+    {
+        o.impl = nullptr;
+    }
+    
+    Statistics::~Statistics( void )
+    {
+        delete this->impl;
+    }
+    
+    Statistics & Statistics::operator =( Statistics o )
+    {
+        swap( *( this ), o );
+        
+        return *( this );
+    }
+    
+    void swap( Statistics & o1, Statistics & o2 )
+    {
+        using std::swap;
+        
+        swap( o1.impl, o2.impl );
+    }
+    
+    void Statistics::Add( const Message & msg )
+    {
+        size_t   level;
+        size_t   source;
+        uint64_t time;
+        
+        level  = static_cast< size_t >( msg.GetLevel() );
+        source = static_cast< size_t >( msg.GetSource() );
+        time   = msg.GetTime();
+        
+        if( level >= LevelCount || source >= SourceCount )
+        {
+            return;
+        }
+        
+        this->impl->_levels[ level ].value.fetch_add( 1, std::memory_order_relaxed );
+        this->impl->_sources[ source ].value.fetch_add( 1, std::memory_order_relaxed );
+        
+        AddToBucket( this->impl->_seconds[ time % BucketCount ],          time,      level );
+        AddToBucket( this->impl->_minutes[ ( time / 60 ) % BucketCount ], time / 60, level );
+    }
+    
+    void Statistics::AddDrop( Drop reason, Message::Level level )
+    {
+        if( static_cast< size_t >( reason ) >= DropCount || static_cast< size_t >( level ) >= LevelCount )
+        {
+            return;
+        }
+        
+        this->impl->_drops[ reason ][ level ].value.fetch_add( 1, std::memory_order_relaxed );
+    }
+    
+    uint64_t Statistics::GetTime( void ) const
+    {
+        return this->impl->_time;
+    }
+    
+    uint64_t Statistics::GetCount( void ) const
+    {
+        uint64_t n;
+        
+        n = 0;
+        
+        for( const auto & count: this->impl->_levels )
+        {
+            n += count.value.load( std::memory_order_relaxed );
+        }
+        
+        return n;
+    }
+    
+    uint64_t Statistics::GetCount( Message::Level level ) const
+    {
+        if( static_cast< size_t >( level ) >= LevelCount )
+        {
+            return 0;
+        }
+        
+        return this->impl->_levels[ level ].value.load( std::memory_order_relaxed );
+    }
+    
+    uint64_t Statistics::GetCount( Message::Source source ) const
+    {
+        if( static_cast< size_t >( source ) >= SourceCount )
+        {
+            return 0;
+        }
+        
+        return this->impl->_sources[ source ].value.load( std::memory_order_relaxed );
+    }
+    
+    uint64_t Statistics::GetDrops( Drop reason ) const
+    {
+        uint64_t n;
+        
+        n = 0;
+        
+        if( static_cast< size_t >( reason ) >= DropCount )
+        {
+            return 0;
+        }
+        
+        for( const auto & count: this->impl->_drops[ reason ] )
+        {
+            n += count.value.load( std::memory_order_relaxed );
+        }
+        
+        return n;
+    }
+    
+    uint64_t Statistics::GetDrops( Drop reason, Message::Level level ) const
+    {
+        if( static_cast< size_t >( reason ) >= DropCount || static_cast< size_t >( level ) >= LevelCount )
+        {
+            return 0;
+        }
+        
+        return this->impl->_drops[ reason ][ level ].value.load( std::memory_order_relaxed );
+    }
+    
+    uint64_t Statistics::GetCountInLastMinute( uint64_t levelMask ) const
+    {
+        uint64_t n;
+        
+        n = 0;
+        
+        for( uint64_t count: this->GetSeconds( levelMask ) )
+        {
+            n += count;
+        }
+        
+        return n;
+    }
+    
+    uint64_t Statistics::GetCountInLastHour( uint64_t levelMask ) const
+    {
+        uint64_t n;
+        
+        n = 0;
+        
+        for( uint64_t count: this->GetMinutes( levelMask ) )
+        {
+            n += count;
+        }
+        
+        return n;
+    }
+    
+    double Statistics::GetRatePerSecond( uint64_t levelMask ) const
+    {
+        return static_cast< double >( this->GetCountInLastMinute( levelMask ) ) / static_cast< double >( BucketCount );
+    }
+    
+    double Statistics::GetRatePerMinute( uint64_t levelMask ) const
+    {
+        return static_cast< double >( this->GetCountInLastHour( levelMask ) ) / static_cast< double >( BucketCount );
+    }
+    
+    std::vector< uint64_t > Statistics::GetSeconds( uint64_t levelMask ) const
+    {
+        return GetBuckets( this->impl->_seconds, this->impl->_time, levelMask );
+    }
+    
+    std::vector< uint64_t > Statistics::GetMinutes( uint64_t levelMask ) const
+    {
+        return GetBuckets( this->impl->_minutes, this->impl->_time / 60, levelMask );
+    }
+    
+    Statistics::IMPL::IMPL( void ):
+        _time( static_cast< uint64_t >( std::time( nullptr ) ) )
+    {
+        for( auto & count: this->_levels )
+        {
+            count.value.store( 0, std::memory_order_relaxed );
+        }
+        
+        for( auto & count: this->_sources )
+        {
+            count.value.store( 0, std::memory_order_relaxed );
+        }
+        
+        for( auto & counts: this->_drops )
+        {
+            for( auto & count: counts )
+            {
+                count.value.store( 0, std::memory_order_relaxed );
+            }
+        }
+        
+        for( auto & bucket: this->_seconds )
+        {
+            bucket.time.store( 0, std::memory_order_relaxed );
+        }
+        
+        for( auto & bucket: this->_minutes )
+        {
+            bucket.time.store( 0, std::memory_order_relaxed );
+        }
+    }
+    
+    /*
+     * Copying is how a snapshot is taken: relaxed loads only, so readers
+     * never block the logging path, and the windows are relative to now.
+     */
+    Statistics::IMPL::IMPL( const IMPL & o ):
+        _time( static_cast< uint64_t >( std::time( nullptr ) ) )
+    {
+        for( size_t i = 0; i < LevelCount; i++ )
+        {
+            this->_levels[ i ].value.store( o._levels[ i ].value.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+        }
+        
+        for( size_t i = 0; i < SourceCount; i++ )
+        {
+            this->_sources[ i ].value.store( o._sources[ i ].value.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+        }
+        
+        for( size_t i = 0; i < DropCount; i++ )
+        {
+            for( size_t j = 0; j < LevelCount; j++ )
+            {
+                this->_drops[ i ][ j ].value.store( o._drops[ i ][ j ].value.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+            }
+        }
+        
+        for( size_t i = 0; i < BucketCount; i++ )
+        {
+            CopyBucket( this->_seconds[ i ], o._seconds[ i ] );
+            CopyBucket( this->_minutes[ i ], o._minutes[ i ] );
+        }
+    }
+    
+    Statistics::IMPL::~IMPL( void )
+    {}
+}
@@ -44,17 +44,20 @@ static void init( void )
 #endif
 
 @property( atomic, readwrite, strong ) ULogLogger                   * logger;
-@property( atomic, readwrite, strong ) ULogMessage                  * lastMessage;
+@property( atomic, readwrite, strong ) NSMutableArray               * messages;
 @property( atomic, readwrite, strong ) ULogSettingsWindowController * settingsWindowController;
-@property( atomic, readwrite, strong ) NSAttributedString           * log;
+@property( atomic, readwrite, strong ) NSMutableArray               * lengths;
 @property( atomic, readwrite, strong ) NSAttributedString           * lf;
 @property( atomic, readwrite, strong ) NSString                     * searchText;
+@property( atomic, readwrite, strong ) NSString                     * renderedSearchText;
 @property( atomic, readwrite, strong ) NSString                     * pauseButtonTitle;
 @property( atomic, readwrite, strong ) NSTimer                      * timer;
 @property( atomic, readwrite, assign ) BOOL                           shown;
 @property( atomic, readwrite, assign ) BOOL                           paused;
 @property( atomic, readwrite, assign ) BOOL                           editable;
 @property( atomic, readwrite, assign ) BOOL                           refreshing;
+@property( atomic, readwrite, assign ) BOOL                           needsFullRender;
+@property( atomic, readwrite, assign ) uint64_t                       sequence;
 
 #ifdef MAC_OS_X_VERSION_10_12_1
 @property( atomic, readwrite, strong ) id touchBar;
@@ -76,7 +79,7 @@ static void init( void )
 - ( void )updateTitleWithMessageCount: ( NSUInteger )count;
 - ( void )startRefreshIfNecessary;
 - ( void )refresh;
-- ( void )renderMessages: ( NSArray * )messages until: ( ULogMessage * )last;
+- ( void )renderMessages: ( NSArray * )messages append: ( BOOL )append;
 - ( NSAttributedString * )stringForMessage: ( ULogMessage * )message;
 - ( NSDictionary * )foregroundAttributesForLevel: ( ULogMessageLevel )level;
 - ( NSDictionary * )processAttributesForLevel: ( ULogMessageLevel )level;
@@ -146,8 +149,9 @@ static void init( void )
 {
     if( ( self = [ super initWithWindowNibName: name ] ) )
     {
-        self.log    = [ NSMutableAttributedString new ];
-        self.lf     = [ [ NSAttributedString alloc ] initWithString: @"\n" attributes: nil ];
+        self.lengths    = [ NSMutableArray new ];
+        self.lf         = [ [ NSAttributedString alloc ] initWithString: @"\n" attributes: nil ];
+        self.messages   = [ NSMutableArray new ];
         
         [ [ NSNotificationCenter defaultCenter ] addObserver: self selector: @selector( updateSettings ) name: ULogSettingsNotificationDefaultsChanged  object: nil ];
         [ [ NSNotificationCenter defaultCenter ] addObserver: self selector: @selector( updateSettings ) name: ULogSettingsNotificationDefaultsRestored object: nil ];
@@ -191,9 +195,11 @@ static void init( void )
     {
         [ self.logger clear ];
         [ self updateTitleWithMessageCount: 0 ];
+        [ self.messages removeAllObjects ];
+        [ self.lengths removeAllObjects ];
+        [ self.textView.textStorage setAttributedString: [ NSAttributedString new ] ];
         
-        self.lastMessage = nil;
-        self.log         = nil;
+        self.needsFullRender = YES;
     }
 }
 
@@ -268,7 +274,7 @@ static void init( void )
                 return;
             }
             
-            data = [ self.log.string dataUsingEncoding: NSUTF8StringEncoding ];
+            data = [ self.textView.textStorage.string dataUsingEncoding: NSUTF8StringEncoding ];
             
             [ data writeToFile: path atomically: YES ];
         }
@@ -312,7 +318,7 @@ static void init( void )
                 return;
             }
             
-            log  = self.log;
+            log  = [ self.textView.textStorage copy ];
             data = [ log RTFFromRange: NSMakeRange( 0, log.length ) documentAttributes: @{} ];
             
             [ data writeToFile: path atomically: YES ];
@@ -340,6 +346,7 @@ static void init( void )
     @synchronized( self )
     {
         self.textView.backgroundColor = [ ULogSettings sharedInstance ].colorTheme.debugColors.backgroundColor;
+        self.needsFullRender          = YES;
     }
 }
 
@@ -370,6 +377,10 @@ static void init( void )
 - ( void )refresh
 {
     NSArray< ULogMessage * > * messages;
+    NSArray< ULogMessage * > * all;
+    uint64_t                   next;
+    NSUInteger                 limit;
+    BOOL                       full;
     
     self.refreshing = YES;
     
@@ -382,22 +393,36 @@ static void init( void )
             return;
         }
         
-        messages = self.logger.messages;
-        
-        if( self.paused )
+        @synchronized( self )
         {
-            if( self.log )
+            messages = @[];
+            full     = NO;
+            
+            if( self.paused == NO )
             {
-                [ self renderMessages: messages until: self.lastMessage ];
+                messages      = [ self.logger messagesSince: self.sequence limit: 0 next: &next ];
+                self.sequence = next;
+                
+                [ self.messages addObjectsFromArray: messages ];
+                
+                limit = self.logger.historyLimit;
+                
+                if( limit > 0 && self.messages.count > limit )
+                {
+                    [ self.messages removeObjectsInRange: NSMakeRange( 0, self.messages.count - limit ) ];
+                }
             }
             
-            [ NSThread sleepForTimeInterval: 0.5 ];
+            if( self.needsFullRender || ( self.searchText != self.renderedSearchText && [ self.searchText isEqualToString: self.renderedSearchText ] == NO ) )
+            {
+                full                    = YES;
+                self.needsFullRender    = NO;
+                self.renderedSearchText = self.searchText;
+            }
             
-            continue;
+            all = ( full ) ? [ self.messages copy ] : nil;
         }
         
-        self.lastMessage = messages.lastObject;
-        
         if( messages.count && self.shown == NO )
         {
             self.shown = YES;
@@ -412,24 +437,42 @@ static void init( void )
             );
         }
         
-        [ self renderMessages: messages until: nil ];
+        if( full )
+        {
+            [ self renderMessages: all append: NO ];
+        }
+        else if( messages.count )
+        {
+            [ self renderMessages: messages append: YES ];
+        }
+        
         [ NSThread sleepForTimeInterval: 0.5 ];
     }
 }
 
-- ( void )renderMessages: ( NSArray * )messages until: ( ULogMessage * )last
+- ( void )renderMessages: ( NSArray * )messages append: ( BOOL )append
 {
     NSPredicate               * predicate;
-    NSMutableAttributedString * log;
+    NSSet                     * matches;
+    NSMutableAttributedString * chunk;
+    NSMutableArray            * lengths;
+    NSAttributedString        * str;
     ULogMessage               * message;
-    NSUInteger                  i;
-        
-    log = [ NSMutableAttributedString new ];
-    i   = 0;
+    NSUInteger                  limit;
+    
+    chunk   = [ NSMutableAttributedString new ];
+    lengths = [ NSMutableArray new ];
+    limit   = self.logger.historyLimit;
     
-    if( self.searchText.length )
+    if( self.renderedSearchText.length && append )
     {
-        predicate = [ NSPredicate predicateWithFormat: @"message contains[c] %@", self.searchText ];
+        predicate = [ NSPredicate predicateWithFormat: @"message contains[c] %@", self.renderedSearchText ];
+        messages  = [ messages filteredArrayUsingPredicate: predicate ];
+    }
+    else if( self.renderedSearchText.length )
+    {
+        matches   = [ NSSet setWithArray: [ self.logger search: self.renderedSearchText options: ULogLoggerSearchOptionCaseInsensitive ] ];
+        predicate = [ NSPredicate predicateWithFormat: @"sequence IN %@", matches ];
         messages  = [ messages filteredArrayUsingPredicate: predicate ];
     }
     
@@ -500,14 +543,10 @@ static void init( void )
             continue;
         }
         
-        i++;
-        
-        [ log appendAttributedString: [ self stringForMessage: message ] ];
+        str = [ self stringForMessage: message ];
         
-        if( last && [ message isEqual: last ] )
-        {
-            break;
-        }
+        [ chunk appendAttributedString: str ];
+        [ lengths addObject: [ NSNumber numberWithUnsignedInteger: str.length ] ];
     }
     
     dispatch_sync
@@ -515,19 +554,62 @@ static void init( void )
         dispatch_get_main_queue(),
         ^( void )
         {
-            NSRange r1;
-            NSRange r2;
-            NSPoint origin;
-            double  pos;
+            NSRange      r1;
+            NSRange      r2;
+            NSPoint      origin;
+            double       pos;
+            NSUInteger   removed;
+            NSUInteger   n;
+            NSNumber   * length;
             
             @try
             {
                 pos = self.textView.enclosingScrollView.verticalScroller.doubleValue;
                 r1  = [ self.textView.layoutManager glyphRangeForBoundingRect: [ self.textView visibleRect ] inTextContainer: self.textView.textContainer ];
                 r2  = [ self.textView.layoutManager characterRangeForGlyphRange: r1 actualGlyphRange: &r2 ];
+            }
+            @catch( NSException * e )
+            {
+                ( void )e;
                 
-                self.log = log;
+                pos = 1;
+                r2  = NSMakeRange( 0, 0 );
+            }
+            
+            [ self.textView.textStorage beginEditing ];
+            
+            if( append )
+            {
+                [ self.textView.textStorage appendAttributedString: chunk ];
+                [ self.lengths addObjectsFromArray: lengths ];
+            }
+            else
+            {
+                [ self.textView.textStorage setAttributedString: chunk ];
+                [ self.lengths setArray: lengths ];
+            }
+            
+            removed = 0;
+            
+            if( limit > 0 && self.lengths.count > limit )
+            {
+                n = self.lengths.count - limit;
                 
+                for( length in [ self.lengths subarrayWithRange: NSMakeRange( 0, n ) ] )
+                {
+                    removed += length.unsignedIntegerValue;
+                }
+                
+                [ self.textView.textStorage deleteCharactersInRange: NSMakeRange( 0, removed ) ];
+                [ self.lengths removeObjectsInRange: NSMakeRange( 0, n ) ];
+            }
+            
+            [ self.textView.textStorage endEditing ];
+            
+            r2.location = ( r2.location > removed ) ? r2.location - removed : 0;
+            
+            @try
+            {
                 if( fabs( pos - 1 ) < DBL_EPSILON )
                 {
                     if( [ [ self.textView.enclosingScrollView documentView ] isFlipped ] )
@@ -552,15 +634,13 @@ static void init( void )
                 {
                     [ self.textView scrollRangeToVisible: r2 ];
                 }
-                
-                [ self updateTitleWithMessageCount: i ];
             }
             @catch( NSException * e )
             {
                 ( void )e;
-                
-                self.log = log;
             }
+            
+            [ self updateTitleWithMessageCount: self.lengths.count ];
         }
     );
 }
@@ -168,6 +168,22 @@
     }
 }
 
+- ( NSUInteger )historyLimit
+{
+    @synchronized( self )
+    {
+        return self.cxxLogger->GetHistoryLimit();
+    }
+}
+
+- ( void )setHistoryLimit: ( NSUInteger )limit
+{
+    @synchronized( self )
+    {
+        self.cxxLogger->SetHistoryLimit( limit );
+    }
+}
+
 - ( NSArray< ULogMessage * > * )messages
 {
     NSMutableArray< ULogMessage * > * array;
@@ -193,6 +209,56 @@
     }
 }
 
+- ( NSArray< ULogMessage * > * )messagesSince: ( uint64_t )sequence limit: ( NSUInteger )limit next: ( uint64_t * )next
+{
+    NSMutableArray< ULogMessage * > * array;
+    std::vector< ULog::Message >      messages;
+    ULogMessage                     * message;
+    uint64_t                          n;
+    
+    @synchronized( self )
+    {
+        messages = self.cxxLogger->GetMessagesSince( sequence, limit, n );
+        array    = [ [ NSMutableArray alloc ] initWithCapacity: messages.size() ];
+        
+        for( const auto & m: messages )
+        {
+            message = [ [ ULogMessage alloc ] initWithCXXMessage: m ];
+            
+            if( message )
+            {
+                [ array addObject: message ];
+            }
+        }
+        
+        if( next != NULL )
+        {
+            *( next ) = n;
+        }
+        
+        return [ NSArray arrayWithArray: array ];
+    }
+}
+
+- ( NSArray< NSNumber * > * )search: ( NSString * )query options: ( uint64_t )options
+{
+    NSMutableArray< NSNumber * > * array;
+    std::vector< uint64_t >        sequences;
+    
+    @synchronized( self )
+    {
+        sequences = self.cxxLogger->Search( ( query.UTF8String ) ? query.UTF8String : "", options );
+        array     = [ [ NSMutableArray alloc ] initWithCapacity: sequences.size() ];
+        
+        for( uint64_t seq: sequences )
+        {
+            [ array addObject: [ NSNumber numberWithUnsignedLongLong: seq ] ];
+        }
+        
+        return [ NSArray arrayWithArray: array ];
+    }
+}
+
 - ( void )clear
 {
     @synchronized( self )
@@ -46,6 +46,7 @@
 @property( atomic, readwrite, assign ) uint64_t          milliseconds;
 @property( atomic, readwrite, assign ) uint64_t          processID;
 @property( atomic, readwrite, assign ) uint64_t          threadID;
+@property( atomic, readwrite, assign ) uint64_t          sequence;
 @property( atomic, readwrite, strong ) NSDate          * date;
 
 @end
@@ -151,6 +152,7 @@
         self.milliseconds   = message.GetMilliseconds();
         self.processID      = message.GetProcessID();
         self.threadID       = message.GetThreadID();
+        self.sequence       = message.GetSequence();
         self.date           = [ NSDate dateWithTimeIntervalSince1970: self.time ];
         
         switch( message.GetLevel() )